@@ -0,0 +1,35 @@
+# Build the external sort tool (ExternalSort + CSVReader + OrderBookEntry + BinaryIO + TimeKey).
+# Sorts a CSV larger than RAM by (product, timestamp) into one columnar binary file.
+# Usage: .\scripts\build-ExternalSort.ps1 <input.csv> <output.obc> [runMegabytes] [threads]
+# If g++ not found: install MSYS2, run pacman -S mingw-w64-ucrt-x86_64-gcc, add bin to PATH.
+# See docs/windows-gcc-setup.md and docs/orderbook-loading.md.
+
+$ErrorActionPreference = "Stop"
+$repoRoot = (Split-Path $PSScriptRoot -Parent)
+Set-Location $repoRoot
+
+if (-not (Test-Path "build")) { New-Item -ItemType Directory -Path "build" | Out-Null }
+$out = "build/ExternalSort.exe"
+
+$mingwPaths = @("C:\msys64\ucrt64\bin", "C:\msys64\mingw64\bin")
+foreach ($p in $mingwPaths) {
+    if (Test-Path "$p\g++.exe") { $env:PATH = "$p;$env:PATH"; break }
+}
+
+$src = @("src/ExternalSort.cpp", "src/CSVReader.cpp", "src/OrderBookEntry.cpp", "src/BinaryIO.cpp", "src/TimeKey.cpp")
+
+if (-not (Get-Command g++ -ErrorAction SilentlyContinue)) {
+    Write-Host "ERROR: g++ not found. See docs/windows-gcc-setup.md." -ForegroundColor Red
+    exit 1
+}
+
+Write-Host "===== Build ($($src -join ', ')) =====" -ForegroundColor Cyan
+& g++ -std=c++17 -Wall -O2 -pthread -Isrc -DEXTERNALSORT_STANDALONE -o $out $src
+if ($LASTEXITCODE -ne 0) { Write-Host "Build failed." -ForegroundColor Red; exit $LASTEXITCODE }
+
+if ($args.Count -ge 2) {
+    Write-Host "===== Run =====" -ForegroundColor Cyan
+    & ".\$out" @args
+    exit $LASTEXITCODE
+}
+Write-Host "Built $out. Run: $out <input.csv> <output.obc> [runMegabytes] [threads]"
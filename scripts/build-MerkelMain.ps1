@@ -17,7 +17,7 @@ foreach ($p in $mingwPaths) {
     if (Test-Path "$p\g++.exe") { $env:PATH = "$p;$env:PATH"; break }
 }
 
-$src = @("src/MerkelMain.cpp", "src/OrderBookEntry.cpp", "src/OrderBook.cpp", "src/CSVReader.cpp")
+$src = @("src/MerkelMain.cpp", "src/OrderBookEntry.cpp", "src/OrderBook.cpp", "src/CSVReader.cpp", "src/StopOrderIndex.cpp", "src/PriceLevelIndex.cpp", "src/TimeKey.cpp", "src/EytzingerIndex.cpp", "src/RangeStats.cpp", "src/BookHistory.cpp", "src/SummaryTable.cpp", "src/ReloadableOrderBook.cpp", "src/BinaryIO.cpp", "src/ConsolidatedBook.cpp", "src/ExportWriter.cpp", "src/CompressedColumns.cpp", "src/OrderQuery.cpp", "src/GroupBy.cpp", "src/AsOfJoin.cpp", "src/VolatilityMonitor.cpp", "src/CorrelationMatrix.cpp", "src/Heatmap.cpp", "src/TimePyramid.cpp", "src/ExecutionSimulator.cpp", "src/TopOrders.cpp")
 
 if (-not (Get-Command g++ -ErrorAction SilentlyContinue)) {
     Write-Host "ERROR: g++ not found. Install MSYS2 and add its bin folder to PATH." -ForegroundColor Red
@@ -27,7 +27,7 @@ if (-not (Get-Command g++ -ErrorAction SilentlyContinue)) {
 }
 
 Write-Host "===== Build ($($src -join ', ')) =====" -ForegroundColor Cyan
-& g++ -std=c++17 -Wall -g -Isrc -o $out $src
+& g++ -std=c++17 -Wall -g -pthread -Isrc -o $out $src
 if ($LASTEXITCODE -ne 0) { Write-Host "Build failed." -ForegroundColor Red; exit $LASTEXITCODE }
 
 Write-Host "===== Run (cwd = repo root so data/ is found) =====" -ForegroundColor Cyan
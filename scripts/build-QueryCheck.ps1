@@ -0,0 +1,34 @@
+# Build and run the paged-query check (QueryCheck + the OrderBook library sources of build-MerkelMain.ps1).
+# Runs every bulk query with and without a memory budget and prints PASS / FAIL per query.
+# Usage: .\scripts\build-QueryCheck.ps1 from repo root. Exit code = number of failed checks.
+# If g++ not found: install MSYS2, run pacman -S mingw-w64-ucrt-x86_64-gcc, add bin to PATH.
+# See docs/windows-gcc-setup.md and docs/orderbook-retention.md.
+
+$ErrorActionPreference = "Stop"
+$repoRoot = (Split-Path $PSScriptRoot -Parent)
+Set-Location $repoRoot
+
+if (-not (Test-Path "build")) { New-Item -ItemType Directory -Path "build" | Out-Null }
+$out = "build/QueryCheck.exe"
+
+$mingwPaths = @("C:\msys64\ucrt64\bin", "C:\msys64\mingw64\bin")
+foreach ($p in $mingwPaths) {
+    if (Test-Path "$p\g++.exe") { $env:PATH = "$p;$env:PATH"; break }
+}
+
+# Same library as MerkelMain, without its main().
+$line = Select-String -Path "scripts/build-MerkelMain.ps1" -Pattern '^\$src = @' | Select-Object -First 1
+$src = @("src/QueryCheck.cpp") + ([regex]::Matches($line.Line, '"(src/[^"]+)"') | ForEach-Object { $_.Groups[1].Value } | Where-Object { $_ -ne "src/MerkelMain.cpp" })
+
+if (-not (Get-Command g++ -ErrorAction SilentlyContinue)) {
+    Write-Host "ERROR: g++ not found. See docs/windows-gcc-setup.md." -ForegroundColor Red
+    exit 1
+}
+
+Write-Host "===== Build ($($src -join ', ')) =====" -ForegroundColor Cyan
+& g++ -std=c++17 -Wall -O2 -pthread -Isrc -o $out $src
+if ($LASTEXITCODE -ne 0) { Write-Host "Build failed." -ForegroundColor Red; exit $LASTEXITCODE }
+
+Write-Host "===== Run =====" -ForegroundColor Cyan
+& ".\$out"
+exit $LASTEXITCODE
@@ -0,0 +1,56 @@
+/*
+ * AsOfJoin.cpp — the linear as-of merge (see AsOfJoin.h).
+ *
+ * PURPOSE: Walk events in time order and summary rows in time order together, keeping the latest row
+ * per product.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-time.md — As-of join.
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc.
+ */
+
+#include "AsOfJoin.h"
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+std::vector<AsOfQuote> AsOfJoin::join(const std::vector<SummaryRow>& rows, const std::vector<AsOfEvent>& events) {
+    std::vector<AsOfQuote> quotes(events.size());
+
+    // Visit events in time order; skip the sort when they already are (the usual case for a fill log).
+    std::vector<std::size_t> order;
+    const bool sorted = std::is_sorted(events.begin(), events.end(), [](const AsOfEvent& a, const AsOfEvent& b) {
+        return a.timestamp < b.timestamp;
+    });
+    if (!sorted) {
+        order.resize(events.size());
+        std::iota(order.begin(), order.end(), std::size_t{0});
+        std::stable_sort(order.begin(), order.end(), [&events](std::size_t a, std::size_t b) {
+            return events[a].timestamp < events[b].timestamp;
+        });
+    }
+
+    std::unordered_map<std::string, const SummaryRow*> latest;  // product → its newest row so far
+    std::size_t next = 0;                                       // first row not yet visited
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        const std::size_t e = sorted ? i : order[i];
+        const AsOfEvent& event = events[e];
+        for (; next < rows.size() && rows[next].timestamp <= event.timestamp; ++next) {
+            latest[rows[next].product] = &rows[next];
+        }
+        auto it = latest.find(event.product);
+        if (it == latest.end()) continue;
+        const SummaryRow& row = *it->second;
+        AsOfQuote& quote = quotes[e];
+        quote.found = true;
+        quote.bookTime = row.timestamp;
+        quote.bestBid = row.bestBid;
+        quote.bestAsk = row.bestAsk;
+        quote.bidVolume = row.bidVolume;
+        quote.askVolume = row.askVolume;
+        quote.bidCount = row.bidCount;
+        quote.askCount = row.count - row.bidCount;
+    }
+    return quotes;
+}
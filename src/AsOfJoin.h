@@ -0,0 +1,60 @@
+/*
+ * AsOfJoin.h — attach to each event (trade, fill, timestamp) the latest book state of its product at
+ * or before the event's time.
+ *
+ * PURPOSE: Execution-quality reports join millions of fills to the book ("what were best bid / ask and
+ * the resting volume when this filled?"). Per event, getPreviousTime + getOrders + a best-price scan
+ * costs a tree walk and a bucket copy; over millions of events that is hopeless.
+ *
+ * DESIGN:
+ *   - The book side is the SummaryTable: one row per (product, timestamp) with best bid/ask, bid/ask
+ *     volume and counts, already sorted by time. No orders are read.
+ *   - join() is one linear merge of two time-sorted sequences. A cursor walks the summary rows; before
+ *     each event it advances over every row with timestamp <= the event's, recording each row as its
+ *     product's latest. The event's answer is then its product's latest row: O(rows + events) in total.
+ *   - Events need not arrive sorted: if they are not, an index permutation is sorted by timestamp
+ *     (stable) and results are still returned in input order.
+ *   - Tradeoff: "book state" is the bucket summary (top of book and total volume per side), not the
+ *     full depth; for levels at the matched time call getDepth / getOrders with quote.bookTime.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-time.md — As-of join: book state at or before each event.
+ *
+ * USE: Include "AsOfJoin.h"; link AsOfJoin.cpp. Call OrderBook::asOfJoin. Build with -Isrc.
+ */
+
+#pragma once
+
+#include "SummaryTable.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/** One event to join: a trade, a fill, or just a time of interest, for one product. */
+struct AsOfEvent {
+    std::string timestamp;
+    std::string product;
+};
+
+/** Book state of the event's product at the latest timestamp <= the event's timestamp. */
+struct AsOfQuote {
+    bool found{false};     /** false if the product has no book at or before the event */
+    std::string bookTime;  /** timestamp of the matched book state */
+    double bestBid{0.0};   /** 0.0 if that book has no bids */
+    double bestAsk{0.0};   /** 0.0 if that book has no asks */
+    double bidVolume{0.0};
+    double askVolume{0.0};
+    std::size_t bidCount{0};
+    std::size_t askCount{0};
+
+    /** (bestBid + bestAsk) / 2; 0.0 unless both sides are present. */
+    double mid() const { return (bestBid > 0.0 && bestAsk > 0.0) ? (bestBid + bestAsk) / 2.0 : 0.0; }
+    /** bestAsk - bestBid; 0.0 unless both sides are present. */
+    double spread() const { return (bestBid > 0.0 && bestAsk > 0.0) ? bestAsk - bestBid : 0.0; }
+};
+
+namespace AsOfJoin {
+    /** Join events to rows (sorted by (timestamp, product), as SummaryTable::rows()). One quote per
+        event, in the order of events. */
+    std::vector<AsOfQuote> join(const std::vector<SummaryRow>& rows, const std::vector<AsOfEvent>& events);
+}
@@ -0,0 +1,97 @@
+/*
+ * BinaryIO.cpp — write/read partition blocks (see BinaryIO.h for the layout).
+ *
+ * PURPOSE: Fixed-size fields appended as raw bytes (a block is built in memory, then written once);
+ * strings as length + bytes. Reading checks the magic and length fields so a truncated or foreign file
+ * stops cleanly instead of allocating garbage.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-retention.md — Spill files.
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc.
+ */
+
+#include "BinaryIO.h"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+namespace {
+    constexpr std::uint32_t kMagic = 0x3150424F;  // "OBP1" little-endian
+    constexpr std::uint32_t kMaxString = 1u << 16;  /** sanity bound for product / timestamp length */
+
+    constexpr std::size_t kRecordBytes = 2 * sizeof(double) + 1;  /** price, amount, side */
+
+    template <typename T>
+    void put(std::string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof value);
+    }
+
+    template <typename T>
+    bool get(std::istream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof value));
+    }
+
+    void putString(std::string& out, const std::string& s) {
+        put(out, static_cast<std::uint32_t>(s.size()));
+        out.append(s);
+    }
+
+    bool getString(std::istream& in, std::string& s) {
+        std::uint32_t length = 0;
+        if (!get(in, length) || length > kMaxString) return false;
+        s.resize(length);
+        return length == 0 || static_cast<bool>(in.read(&s[0], length));
+    }
+}
+
+// -------- writePartition / appendPartition --------
+// The block is built in memory and written with one call, so a spill of many small blocks costs one
+// stream write each instead of one per field.
+
+bool BinaryIO::writePartition(std::ostream& out, const std::string& product, const std::string& timestamp,
+                              const std::vector<OrderBookEntry>& entries) {
+    std::string block;
+    appendPartition(block, product, timestamp, entries);
+    out.write(block.data(), static_cast<std::streamsize>(block.size()));
+    return static_cast<bool>(out);
+}
+
+void BinaryIO::appendPartition(std::string& out, const std::string& product, const std::string& timestamp,
+                               const std::vector<OrderBookEntry>& entries) {
+    out.reserve(out.size() + 24 + product.size() + timestamp.size() + entries.size() * kRecordBytes);
+    put(out, kMagic);
+    putString(out, product);
+    putString(out, timestamp);
+    put(out, static_cast<std::uint64_t>(entries.size()));
+    for (const OrderBookEntry& e : entries) {
+        put(out, e.price);
+        put(out, e.amount);
+        put(out, static_cast<std::uint8_t>(e.orderType == OrderBookType::bid ? 0 : 1));
+    }
+}
+
+// -------- readPartition --------
+
+bool BinaryIO::readPartition(std::istream& in, std::string& product, std::string& timestamp,
+                             std::vector<OrderBookEntry>& entries) {
+    std::uint32_t magic = 0;
+    if (!get(in, magic)) return false;  // clean end of file
+    std::uint64_t count = 0;
+    if (magic != kMagic || !getString(in, product) || !getString(in, timestamp) || !get(in, count)) {
+        std::cerr << "BinaryIO: malformed partition block" << std::endl;
+        return false;
+    }
+    entries.clear();
+    entries.reserve(static_cast<std::size_t>(count));
+    for (std::uint64_t i = 0; i < count; ++i) {
+        double price = 0.0, amount = 0.0;
+        std::uint8_t side = 0;
+        if (!get(in, price) || !get(in, amount) || !get(in, side)) {
+            std::cerr << "BinaryIO: truncated partition block" << std::endl;
+            return false;
+        }
+        entries.emplace_back(price, amount, timestamp, product, side == 0 ? OrderBookType::bid : OrderBookType::ask);
+    }
+    return true;
+}
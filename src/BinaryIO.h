@@ -0,0 +1,40 @@
+/*
+ * BinaryIO.h — compact binary blocks of order book partitions (one (product, timestamp) bucket per block).
+ *
+ * PURPOSE: Evicted or spilled partitions need a format that is much smaller and faster than CSV:
+ * no text parsing, no repeated product/timestamp strings. One block stores the product and timestamp
+ * once, then fixed-size records (price, amount, side) for every order in the bucket.
+ *
+ * FORMAT (per block, native byte order — a spill/archive format for the same machine, not an exchange format):
+ *   u32 magic 'OBP1' | u32 productLen | product bytes | u32 timestampLen | timestamp bytes |
+ *   u64 count | count x { f64 price, f64 amount, u8 side (0 = bid, 1 = ask) }
+ * Blocks are simply concatenated; a reader walks them in order, or seeks to a remembered offset.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-retention.md — Retention and spill files; the memory-budget page file (section 4).
+ *   docs/orderbook-loading.md — Binary export (appendPartition).
+ *
+ * USE: Include "BinaryIO.h"; link BinaryIO.cpp. Build with -Isrc.
+ */
+
+#pragma once
+
+#include "OrderBookEntry.h"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace BinaryIO {
+    /** Write one partition block. Returns false if the stream failed. */
+    bool writePartition(std::ostream& out, const std::string& product, const std::string& timestamp,
+                        const std::vector<OrderBookEntry>& entries);
+
+    /** Append the same block to a memory buffer (batched writers, e.g. OrderBook::exportOrders). */
+    void appendPartition(std::string& out, const std::string& product, const std::string& timestamp,
+                         const std::vector<OrderBookEntry>& entries);
+
+    /** Read the next block into product/timestamp/entries (entries replaced). Returns false at end of
+        file or on a malformed block (logged to std::cerr unless it is a clean end of file). */
+    bool readPartition(std::istream& in, std::string& product, std::string& timestamp,
+                       std::vector<OrderBookEntry>& entries);
+}
@@ -0,0 +1,95 @@
+/*
+ * BitOps.h — tiny portable wrappers for bit scans, cache prefetch and the AVX2 check.
+ *
+ * PURPOSE: C++17 has no std::countr_zero (that is C++20), so we wrap the compiler builtins once
+ * here instead of sprinkling #ifdefs through every data structure. Each wrapper compiles to one
+ * instruction on GCC/Clang and MSVC.
+ *
+ * AVX2 kernels are compiled per function (BITOPS_TARGET_AVX2) and picked at run time with
+ * hasAvx2(), so the default build (no -mavx2) ships them and still runs on CPUs without AVX2.
+ * Building with -mavx2 (or /arch:AVX2) makes hasAvx2() a constant true.
+ *
+ * USED BY: PriceLevelIndex (find-first-set over the level bitmap), EytzingerIndex (branchless search);
+ * hasAvx2: BPlusTree, CompressedColumns, OrderQuery, CorrelationMatrix kernels.
+ *
+ * USE: Header-only. Include "BitOps.h". Build with -Isrc.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <xmmintrin.h>
+#endif
+
+// -------- AVX2: BITOPS_AVX2 = kernels can be compiled; BITOPS_TARGET_AVX2 marks them --------
+// GCC/Clang on x86 compile one function for AVX2 with the target attribute, whatever -m flags the
+// rest of the file has. Elsewhere the kernels exist only when the whole build targets AVX2.
+#if defined(__AVX2__)
+#define BITOPS_AVX2 1
+#define BITOPS_TARGET_AVX2
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BITOPS_AVX2 1
+#define BITOPS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define BITOPS_AVX2 0
+#endif
+
+#if BITOPS_AVX2
+#include <immintrin.h>
+#endif
+
+// -------- Bit helpers: index of lowest / highest set bit (word must be non-zero) --------
+// GCC/Clang have builtins; MSVC has _BitScanForward64/_BitScanReverse64. Both compile to one instruction.
+namespace BitOps {
+    inline int lowestSetBit(std::uint64_t word) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+    inline int highestSetBit(std::uint64_t word) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, word);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(word);
+#endif
+    }
+
+    /** Hint the CPU to start loading the cache line at address. Never faults, even past an array's end. */
+    inline void prefetch(const void* address) {
+#if defined(_MSC_VER)
+        _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+        __builtin_prefetch(address);
+#endif
+    }
+
+#if BITOPS_AVX2 && !defined(__AVX2__)
+    /** Checked once at static init; a namespace-scope flag, not a function-local static, so the hot
+        path is one load with no guard. Read before its initializer ran it is false: the scalar path. */
+    inline bool detectAvx2() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }
+    inline const bool kCpuHasAvx2 = detectAvx2();
+#endif
+
+    /** True if BITOPS_TARGET_AVX2 kernels may run on this CPU. */
+    inline bool hasAvx2() {
+#if defined(__AVX2__)
+        return true;
+#elif BITOPS_AVX2
+        return kCpuHasAvx2;
+#else
+        return false;
+#endif
+    }
+}
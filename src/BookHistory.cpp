@@ -0,0 +1,143 @@
+/*
+ * BookHistory.cpp — record level deltas, checkpoint every K timestamps, rebuild past states.
+ *
+ * PURPOSE: record() appends a delta and applies it to the live levels (startSnapshot() appends a reset);
+ * when a new timestamp starts and the previous one was the K-th, the live levels are saved as a
+ * checkpoint. A delta stamped in the past is inserted under its timestamp and the rest replayed.
+ * stateAt() starts from the nearest checkpoint and replays the remaining deltas.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-time.md — Time travel.
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc.
+ */
+
+#include "BookHistory.h"
+#include <algorithm>
+
+namespace {
+    /** Amounts below this are rounding residue from +/− pairs; the level is treated as gone. */
+    constexpr double kEmptyLevel = 1e-12;
+}
+
+// -------- Constructor --------
+
+BookHistory::BookHistory(std::size_t checkpointEvery)
+    : checkpointEvery_(checkpointEvery == 0 ? 1 : checkpointEvery) {}
+
+// -------- record / startSnapshot --------
+// A newer timestamp closes the previous one; a closed K-th timestamp gets a checkpoint. Levels carry
+// forward across timestamps; only startSnapshot (an insert opening a new bucket) clears them.
+
+void BookHistory::record(const std::string& product, const std::string& timestamp, OrderBookType side, double price,
+                         double amountChange) {
+    add(products_[product], timestamp, LevelDelta{side, price, amountChange, false});
+}
+
+void BookHistory::startSnapshot(const std::string& product, const std::string& timestamp) {
+    add(products_[product], timestamp, LevelDelta{OrderBookType::bid, 0.0, 0.0, true});
+}
+
+void BookHistory::add(ProductHistory& h, const std::string& timestamp, const LevelDelta& delta) {
+    if (h.times.empty() || timestamp > h.times.back()) {
+        if (!h.times.empty() && h.times.size() % checkpointEvery_ == 0) {
+            h.checkpoints.push_back({toVector(h.current.bids), toVector(h.current.asks)});
+        }
+        h.times.push_back(timestamp);
+        h.deltaStart.push_back(h.deltas.size());
+    }
+    if (timestamp == h.times.back()) {
+        h.deltas.push_back(delta);
+        apply(h.current, delta);
+        return;
+    }
+    // Stamped in the past: the delta goes at the end of its own timestamp (added if new), and
+    // everything derived from the deltas after it — checkpoints, live levels — is rebuilt.
+    auto time = std::lower_bound(h.times.begin(), h.times.end(), timestamp);
+    const std::size_t i = time - h.times.begin();
+    if (*time != timestamp) {
+        const std::size_t start = h.deltaStart[i];  // empty range: the new timestamp has no deltas yet
+        h.times.insert(time, timestamp);
+        h.deltaStart.insert(h.deltaStart.begin() + i, start);
+    }
+    h.deltas.insert(h.deltas.begin() + h.deltaStart[i + 1], delta);
+    for (std::size_t j = i + 1; j < h.deltaStart.size(); ++j) ++h.deltaStart[j];
+    replayFrom(h, i);
+}
+
+void BookHistory::replayFrom(ProductHistory& h, std::size_t from) {
+    const std::size_t kept = std::min(from / checkpointEvery_, h.checkpoints.size());
+    h.checkpoints.resize(kept);
+    Levels levels = kept > 0 ? fromCheckpoint(h.checkpoints.back()) : Levels{};
+    for (std::size_t t = kept * checkpointEvery_; t < h.times.size(); ++t) {
+        const std::size_t end = (t + 1 < h.times.size()) ? h.deltaStart[t + 1] : h.deltas.size();
+        for (std::size_t d = h.deltaStart[t]; d < end; ++d) apply(levels, h.deltas[d]);
+        if ((t + 1) % checkpointEvery_ == 0 && t + 1 < h.times.size()) {
+            h.checkpoints.push_back({toVector(levels.bids), toVector(levels.asks)});
+        }
+    }
+    h.current = std::move(levels);
+}
+
+// -------- stateAt --------
+// i = last timestamp <= time. The last checkpoint at or before i covers times [0, (cp + 1) * K);
+// replay deltas from there through times[i]. The latest timestamp is just the live levels.
+
+BookSnapshot BookHistory::stateAt(const std::string& product, const std::string& time) const {
+    BookSnapshot snapshot;
+    auto found = products_.find(product);
+    if (found == products_.end()) return snapshot;
+    const ProductHistory& h = found->second;
+    const std::size_t upper = std::upper_bound(h.times.begin(), h.times.end(), time) - h.times.begin();
+    if (upper == 0) return snapshot;
+    const std::size_t i = upper - 1;
+    snapshot.timestamp = h.times[i];
+
+    const Levels* levels = &h.current;
+    Levels rebuilt;
+    if (i + 1 < h.times.size()) {
+        const std::size_t covered = std::min(upper / checkpointEvery_, h.checkpoints.size());
+        std::size_t start = 0;
+        if (covered > 0) {
+            rebuilt = fromCheckpoint(h.checkpoints[covered - 1]);
+            start = covered * checkpointEvery_;
+        }
+        const std::size_t deltaEnd = h.deltaStart[i + 1];
+        for (std::size_t d = h.deltaStart[start]; d < deltaEnd; ++d) apply(rebuilt, h.deltas[d]);
+        levels = &rebuilt;
+    }
+
+    std::vector<PriceLevel> bids = toVector(levels->bids);
+    std::reverse(bids.begin(), bids.end());  // best bid = highest price first
+    snapshot.bids = std::move(bids);
+    snapshot.asks = toVector(levels->asks);
+    return snapshot;
+}
+
+// -------- Helpers --------
+
+BookHistory::Levels BookHistory::fromCheckpoint(const Checkpoint& cp) {
+    Levels levels;
+    for (const PriceLevel& l : cp.bids) levels.bids.emplace_hint(levels.bids.end(), l.price, l.amount);
+    for (const PriceLevel& l : cp.asks) levels.asks.emplace_hint(levels.asks.end(), l.price, l.amount);
+    return levels;
+}
+
+void BookHistory::apply(Levels& levels, const LevelDelta& delta) {
+    if (delta.reset) {
+        levels.bids.clear();
+        levels.asks.clear();
+        return;
+    }
+    std::map<double, double>& side = (delta.side == OrderBookType::bid) ? levels.bids : levels.asks;
+    double& amount = side[delta.price];
+    amount += delta.amountChange;
+    if (amount <= kEmptyLevel) side.erase(delta.price);
+}
+
+std::vector<PriceLevel> BookHistory::toVector(const std::map<double, double>& side) {
+    std::vector<PriceLevel> out;
+    out.reserve(side.size());
+    for (const auto& kv : side) out.push_back({kv.first, kv.second});
+    return out;
+}
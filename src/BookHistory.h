@@ -0,0 +1,102 @@
+/*
+ * BookHistory.h — time travel for the order book: checkpoints every K timestamps plus deltas between.
+ *
+ * PURPOSE: OrderBook's buckets say which orders were placed at a timestamp, but once orders are
+ * cancelled or filled there is no record of what the book looked like at a past time. BookHistory
+ * records every change to a product's price levels (insert = +amount, cancel/fill = −amount) and can
+ * rebuild the levels and best prices at any historical time t.
+ *
+ * DESIGN (checkpoint + delta, like video keyframes):
+ *   - Every change is a LevelDelta recorded under its timestamp; levels carry forward from one
+ *     timestamp to the next.
+ *   - startSnapshot(): a bucket of orders is a full book, not a change to the previous one. When an
+ *     insert opens a new (product, timestamp) bucket, OrderBook records a reset delta first, so the
+ *     previous levels do not carry past it. Cancels and fills are plain deltas: at a later time they
+ *     change the carried-forward book, they do not replace it.
+ *   - After every K-th timestamp is complete we store a full checkpoint of the levels.
+ *   - stateAt(t): find the last timestamp <= t, start from the nearest checkpoint at or before it,
+ *     replay at most ~K timestamps of deltas. Cost is O(levels + K timestamps of deltas), never a
+ *     replay from the start of history.
+ *   - Tradeoff: small K = faster queries, more checkpoint memory; large K = the opposite.
+ *   - A change stamped earlier than the last recorded timestamp goes under its own timestamp; the
+ *     product's checkpoints after it are dropped and rebuilt, and its live levels replayed. Rare
+ *     (a cancel of an old order without atTime, an insert into the past), so O(deltas since then).
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-time.md — Time travel: OrderBook::enableHistory, getBookAt.
+ *
+ * USE: Include "BookHistory.h"; link BookHistory.cpp. OrderBook owns one when enableHistory(K) is
+ * called. Build with -Isrc.
+ */
+
+#pragma once
+
+#include "OrderBookEntry.h"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+/** Book levels of one product at one time. bids best-first (high→low), asks best-first (low→high). */
+struct BookSnapshot {
+    std::string timestamp;  /** last recorded timestamp <= the requested time; empty if none */
+    std::vector<PriceLevel> bids;
+    std::vector<PriceLevel> asks;
+
+    double bestBid() const { return bids.empty() ? 0.0 : bids.front().price; }
+    double bestAsk() const { return asks.empty() ? 0.0 : asks.front().price; }
+};
+
+class BookHistory {
+public:
+    /** checkpointEvery = K: full snapshot after every K-th timestamp (K >= 1). */
+    explicit BookHistory(std::size_t checkpointEvery = 64);
+
+    /** Record amountChange (+ insert, − cancel/fill) at price on side of product, at timestamp. */
+    void record(const std::string& product, const std::string& timestamp, OrderBookType side, double price,
+                double amountChange);
+
+    /** A new full book of product starts at timestamp: levels recorded before it do not carry past it. */
+    void startSnapshot(const std::string& product, const std::string& timestamp);
+
+    /** Levels of product as they were at time (after every change stamped <= time). */
+    BookSnapshot stateAt(const std::string& product, const std::string& time) const;
+
+    void clear() { products_.clear(); }
+
+private:
+    /** Live levels: price → amount. std::map keeps each side sorted for checkpoints. */
+    struct Levels {
+        std::map<double, double> bids;
+        std::map<double, double> asks;
+    };
+    struct LevelDelta {
+        OrderBookType side;
+        double price;
+        double amountChange;
+        bool reset;  /** startSnapshot: clear both sides (side, price, amountChange unused) */
+    };
+    /** Checkpoint = levels after timestamp index (c + 1) * K - 1, stored as sorted vectors. */
+    struct Checkpoint {
+        std::vector<PriceLevel> bids;  /** ascending price */
+        std::vector<PriceLevel> asks;  /** ascending price */
+    };
+    struct ProductHistory {
+        std::vector<std::string> times;         /** distinct timestamps, ascending */
+        std::vector<std::size_t> deltaStart;    /** times[i]'s deltas start at deltaStart[i] (end: next start) */
+        std::vector<LevelDelta> deltas;
+        std::vector<Checkpoint> checkpoints;    /** checkpoints[c] is after times[(c + 1) * K - 1] */
+        Levels current;
+    };
+
+    /** Record delta under timestamp: appended at the latest timestamp, inserted (with a replay) before it. */
+    void add(ProductHistory& h, const std::string& timestamp, const LevelDelta& delta);
+    /** Drop checkpoints after times[from - 1]; rebuild them and the live levels from the deltas. */
+    void replayFrom(ProductHistory& h, std::size_t from);
+    static Levels fromCheckpoint(const Checkpoint& cp);
+    static void apply(Levels& levels, const LevelDelta& delta);
+    static std::vector<PriceLevel> toVector(const std::map<double, double>& side);
+
+    std::size_t checkpointEvery_;
+    std::map<std::string, ProductHistory> products_;
+};
@@ -2,7 +2,7 @@
  * CSVReader.cpp — definitions for CSV reading (tokenize, stringsToOBE, readCSV).
  *
  * PURPOSE: Implements CSVReader declared in CSVReader.h. Reads CSV lines, tokenizes by comma,
- * parses with try/catch; skips bad lines and logs to stderr.
+ * parses with try/catch (parseLine); skips bad lines and logs to stderr.
  *
  * DOCS (embedded references):
  *   docs/tokenizer.md — tokenize(csvLine, ','); getline(ss, token, delimiter).
@@ -60,19 +60,28 @@ int CSVReader::readCSVInto(const std::string& path, std::vector<OrderBookEntry>&
     }
     out.clear();
     std::string line;
+    OrderBookEntry entry;
     while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        std::vector<std::string> tokens = tokenize(line, ',');
-        if (tokens.size() < 5) continue;
-        try {
-            out.push_back(stringsToOBE(tokens));
-        } catch (const std::exception& e) {
-            std::cerr << "Skipped line (invalid number): " << e.what() << std::endl;
-        }
+        if (parseLine(line, entry)) out.push_back(entry);
     }
     return static_cast<int>(out.size());
 }
 
+// -------- parseLine: one line -> entry (shared by readCSVInto and streaming loaders) --------
+// Blank or short lines are skipped silently; stringsToOBE's exceptions are caught and logged here.
+bool CSVReader::parseLine(const std::string& line, OrderBookEntry& out) {
+    if (line.empty()) return false;
+    std::vector<std::string> tokens = tokenize(line, ',');
+    if (tokens.size() < 5) return false;
+    try {
+        out = stringsToOBE(tokens);
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Skipped line (invalid number): " << e.what() << std::endl;
+        return false;
+    }
+}
+
 /** Public API: return new vector of OrderBookEntry. Empty on open failure or parse errors. */
 std::vector<OrderBookEntry> CSVReader::readCSV(const std::string& filename) {
     std::vector<OrderBookEntry> result;
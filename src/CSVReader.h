@@ -29,6 +29,10 @@ public:
     /** Read CSV from path into out (clears out first). Returns count loaded; 0 on error. */
     static int readCSV(const std::string& filename, std::vector<OrderBookEntry>& out);
 
+    /** Parse one CSV line into out (streaming readers, e.g. OrderBook::loadAsync). Returns false for
+        blank/short lines and for bad numbers (logged to stderr, like readCSV). Does not throw. */
+    static bool parseLine(const std::string& line, OrderBookEntry& out);
+
 private:
     /** Split line by delimiter. Does not throw for normal input. See docs/tokenizer.md. */
     static std::vector<std::string> tokenize(const std::string& csvLine, char delimiter);
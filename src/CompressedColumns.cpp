@@ -0,0 +1,283 @@
+/*
+ * CompressedColumns.cpp — encoders and block decode kernels (see CompressedColumns.h).
+ *
+ * PURPOSE: encode() splits entries into columns (RLE time, dictionary product, side bits, two
+ * PackedDoubles); decode() and stats() walk them back block by block.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-retention.md — Memory budget: compressed in-memory cold storage.
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc. The AVX2 decode is picked at run time
+ * (BitOps::hasAvx2), so no -mavx2 is needed.
+ */
+
+#include "CompressedColumns.h"
+#include "BitOps.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <utility>
+
+namespace {
+    constexpr int kMaxDecimals = 12;
+    constexpr int kMaxWidth = 52;  /** offsets must stay exact as doubles (and under the 2^52 trick) */
+    constexpr double kExactLimit = 4503599627370496.0;  /** 2^52: scaled values must stay below this */
+
+    const double kPow10[kMaxDecimals + 1] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12};
+    const double kInvPow10[kMaxDecimals + 1] = {1e0, 1e-1, 1e-2, 1e-3, 1e-4, 1e-5, 1e-6, 1e-7, 1e-8, 1e-9, 1e-10, 1e-11, 1e-12};
+
+    int bitsFor(std::uint64_t maxValue) {
+        int bits = 0;
+        while (bits < 64 && (maxValue >> bits) != 0) ++bits;
+        return bits;
+    }
+
+    // -------- Bit packing: value i of width w lives at bits [i*w, i*w + w) --------
+
+    void packValue(std::vector<std::uint64_t>& words, std::size_t firstWord, std::size_t i, int width,
+                   std::uint64_t value) {
+        if (width == 0) return;
+        const std::size_t bit = i * static_cast<std::size_t>(width);
+        const std::size_t word = firstWord + bit / 64;
+        const int shift = static_cast<int>(bit % 64);
+        words[word] |= value << shift;
+        if (shift + width > 64) words[word + 1] |= value >> (64 - shift);
+    }
+
+    inline std::uint64_t unpackValue(const std::uint64_t* words, std::size_t i, int width) {
+        if (width == 0) return 0;
+        const std::size_t bit = i * static_cast<std::size_t>(width);
+        const std::size_t word = bit / 64;
+        const int shift = static_cast<int>(bit % 64);
+        std::uint64_t value = words[word] >> shift;
+        if (shift + width > 64) value |= words[word + 1] << (64 - shift);
+        return (width == 64) ? value : value & ((std::uint64_t{1} << width) - 1);
+    }
+
+    /** Unpack n offsets of compile-time width W: constant masks, no branch on the width in the loop. */
+    template <int W>
+    void unpackBlock(const std::uint64_t* words, std::size_t n, std::uint64_t* out) {
+        for (std::size_t i = 0; i < n; ++i) out[i] = unpackValue(words, i, W);
+    }
+
+    using UnpackFn = void (*)(const std::uint64_t*, std::size_t, std::uint64_t*);
+
+    template <std::size_t... W>
+    constexpr std::array<UnpackFn, sizeof...(W)> makeUnpackTable(std::index_sequence<W...>) {
+        return {{&unpackBlock<static_cast<int>(W)>...}};
+    }
+
+    /** kUnpack[w] unpacks offsets of width w (0..52). */
+    const auto kUnpack = makeUnpackTable(std::make_index_sequence<kMaxWidth + 1>{});
+
+#if BITOPS_AVX2
+    /** offsetsToDoubles over [0, n rounded down to 4); returns the first value not converted. */
+    BITOPS_TARGET_AVX2 std::size_t offsetsToDoublesAvx2(const std::uint64_t* offsets, std::size_t n, double base,
+                                                        double scale, bool divide, double* out) {
+        // offset < 2^52: OR its bits into the mantissa of 2^52, subtract 2^52 → the offset as a double.
+        const __m256i magicBits = _mm256_set1_epi64x(0x4330000000000000LL);
+        const __m256d magic = _mm256_set1_pd(kExactLimit);
+        const __m256d vbase = _mm256_set1_pd(base);
+        const __m256d vscale = _mm256_set1_pd(scale);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m256i raw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets + i));
+            const __m256d value = _mm256_add_pd(vbase, _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(raw, magicBits)), magic));
+            _mm256_storeu_pd(out + i, divide ? _mm256_div_pd(value, vscale) : _mm256_mul_pd(value, vscale));
+        }
+        return i;
+    }
+#endif
+
+    /** out[i] = (reference + offsets[i]) * 10^-d (or / 10^d when divide), exactly as the encoder checked. */
+    void offsetsToDoubles(const std::uint64_t* offsets, std::size_t n, std::int64_t reference, int decimals,
+                          bool divide, double* out) {
+        const double base = static_cast<double>(reference);
+        const double scale = divide ? kPow10[decimals] : kInvPow10[decimals];
+        std::size_t i = 0;
+#if BITOPS_AVX2
+        if (BitOps::hasAvx2()) i = offsetsToDoublesAvx2(offsets, n, base, scale, divide, out);
+#endif
+        if (divide) {
+            for (; i < n; ++i) out[i] = (base + static_cast<double>(offsets[i])) / scale;
+        } else {
+            for (; i < n; ++i) out[i] = (base + static_cast<double>(offsets[i])) * scale;
+        }
+    }
+
+    /** Smallest decimals d such that every value is exactly k * 10^-d (or k / 10^d when divide) for an
+        integer 0 <= k < 2^52; -1 if none. Negative values and -0.0 stay raw, so decoded bits always match. */
+    int exactDecimals(const double* values, std::size_t n, bool divide, std::int64_t* scaled) {
+        for (int d = 0; d <= kMaxDecimals; ++d) {
+            bool exact = true;
+            for (std::size_t i = 0; i < n && exact; ++i) {
+                const double k = std::nearbyint(values[i] * kPow10[d]);
+                const double back = divide ? k / kPow10[d] : k * kInvPow10[d];
+                exact = k < kExactLimit && back == values[i] && !std::signbit(values[i]);
+                if (exact) scaled[i] = static_cast<std::int64_t>(k);
+            }
+            if (exact) return d;
+        }
+        return -1;
+    }
+}
+
+// -------- PackedDoubles --------
+
+void CompressedColumns::PackedDoubles::encode(const std::vector<double>& values) {
+    clear();
+    count_ = values.size();
+    std::int64_t scaled[kBlock];
+    for (std::size_t start = 0; start < values.size(); start += kBlock) {
+        const std::size_t n = std::min(kBlock, values.size() - start);
+        BlockHeader header;
+        header.wordOffset = static_cast<std::uint32_t>(words_.size());
+        // Multiplying by 10^-d decodes fastest but is exact for fewer values; division is the fallback.
+        int decimals = exactDecimals(values.data() + start, n, false, scaled);
+        header.divide = (decimals < 0);
+        if (header.divide) decimals = exactDecimals(values.data() + start, n, true, scaled);
+        std::int64_t low = 0, high = 0;
+        if (decimals >= 0) {
+            low = *std::min_element(scaled, scaled + n);
+            high = *std::max_element(scaled, scaled + n);
+        }
+        const int width = (decimals >= 0) ? bitsFor(static_cast<std::uint64_t>(high - low)) : 64;
+        if (width > kMaxWidth) {  // not exact, or too wide to decode exactly: keep the raw doubles
+            header.width = 64;
+            words_.resize(words_.size() + n);
+            std::memcpy(&words_[header.wordOffset], values.data() + start, n * sizeof(double));
+        } else {
+            header.width = static_cast<std::uint8_t>(width);
+            header.decimals = static_cast<std::uint8_t>(decimals);
+            header.reference = low;
+            words_.resize(words_.size() + (n * static_cast<std::size_t>(width) + 63) / 64, 0);
+            for (std::size_t i = 0; i < n; ++i) {
+                packValue(words_, header.wordOffset, i, width, static_cast<std::uint64_t>(scaled[i] - low));
+            }
+        }
+        blocks_.push_back(header);
+    }
+    words_.shrink_to_fit();
+    blocks_.shrink_to_fit();
+}
+
+std::size_t CompressedColumns::PackedDoubles::decodeBlock(std::size_t block, double* out) const {
+    if (block >= blocks_.size()) return 0;
+    const BlockHeader& header = blocks_[block];
+    const std::size_t n = std::min(kBlock, count_ - block * kBlock);
+    const std::uint64_t* words = words_.data() + header.wordOffset;
+    if (header.width == 64) {
+        std::memcpy(out, words, n * sizeof(double));
+        return n;
+    }
+    std::uint64_t offsets[kBlock];
+    kUnpack[header.width](words, n, offsets);
+    offsetsToDoubles(offsets, n, header.reference, header.decimals, header.divide, out);
+    return n;
+}
+
+std::size_t CompressedColumns::PackedDoubles::byteSize() const {
+    return blocks_.capacity() * sizeof(BlockHeader) + words_.capacity() * sizeof(std::uint64_t);
+}
+
+void CompressedColumns::PackedDoubles::clear() {
+    blocks_.clear();
+    words_.clear();
+    count_ = 0;
+}
+
+// -------- encode: split into columns --------
+
+void CompressedColumns::encode(const std::vector<OrderBookEntry>& entries) {
+    clear();
+    rows_ = entries.size();
+
+    std::map<std::string, std::uint32_t> productIds;
+    for (const OrderBookEntry& e : entries) productIds.emplace(e.product, 0);
+    for (auto& kv : productIds) {
+        kv.second = static_cast<std::uint32_t>(products_.size());
+        products_.push_back(kv.first);
+    }
+    productBits_ = static_cast<std::uint8_t>(products_.size() > 1 ? bitsFor(products_.size() - 1) : 0);
+    productCodes_.assign((rows_ * productBits_ + 63) / 64, 0);
+    askBits_.assign((rows_ + 63) / 64, 0);
+
+    std::map<std::string, std::uint32_t> timeIds;
+    std::vector<double> prices, amounts;
+    prices.reserve(rows_);
+    amounts.reserve(rows_);
+    for (std::size_t i = 0; i < rows_; ++i) {
+        const OrderBookEntry& e = entries[i];
+        if (timeRuns_.empty() || times_[timeRuns_.back().timeId] != e.timestamp) {
+            auto id = timeIds.emplace(e.timestamp, static_cast<std::uint32_t>(times_.size()));
+            if (id.second) times_.push_back(e.timestamp);
+            timeRuns_.push_back({id.first->second, 0});
+        }
+        ++timeRuns_.back().length;
+        packValue(productCodes_, 0, i, productBits_, productIds[e.product]);
+        if (e.orderType == OrderBookType::ask) askBits_[i / 64] |= std::uint64_t{1} << (i % 64);
+        prices.push_back(e.price);
+        amounts.push_back(e.amount);
+    }
+    prices_.encode(prices);
+    amounts_.encode(amounts);
+    times_.shrink_to_fit();
+    timeRuns_.shrink_to_fit();
+    products_.shrink_to_fit();
+}
+
+// -------- decode / stats: block by block --------
+
+void CompressedColumns::decode(std::vector<OrderBookEntry>& out) const {
+    out.clear();
+    out.reserve(rows_);
+    double prices[kBlock], amounts[kBlock];
+    std::size_t run = 0, leftInRun = timeRuns_.empty() ? 0 : timeRuns_[0].length;
+    for (std::size_t block = 0; block < blockCount(); ++block) {
+        const std::size_t n = prices_.decodeBlock(block, prices);
+        amounts_.decodeBlock(block, amounts);
+        for (std::size_t j = 0; j < n; ++j) {
+            const std::size_t i = block * kBlock + j;
+            while (leftInRun == 0) leftInRun = timeRuns_[++run].length;
+            --leftInRun;
+            const bool ask = (askBits_[i / 64] >> (i % 64)) & 1;
+            out.emplace_back(prices[j], amounts[j], times_[timeRuns_[run].timeId],
+                             products_[unpackValue(productCodes_.data(), i, productBits_)],
+                             ask ? OrderBookType::ask : OrderBookType::bid);
+        }
+    }
+}
+
+BucketStats CompressedColumns::stats() const {
+    BucketStats stats;
+    double prices[kBlock], amounts[kBlock];
+    for (std::size_t block = 0; block < blockCount(); ++block) {
+        const std::size_t n = prices_.decodeBlock(block, prices);
+        amounts_.decodeBlock(block, amounts);
+        for (std::size_t j = 0; j < n; ++j) stats.add(prices[j], amounts[j]);
+    }
+    return stats;
+}
+
+std::size_t CompressedColumns::byteSize() const {
+    std::size_t bytes = prices_.byteSize() + amounts_.byteSize();
+    bytes += timeRuns_.capacity() * sizeof(TimeRun);
+    bytes += productCodes_.capacity() * sizeof(std::uint64_t) + askBits_.capacity() * sizeof(std::uint64_t);
+    for (const std::string& t : times_) bytes += sizeof(std::string) + t.capacity();
+    for (const std::string& p : products_) bytes += sizeof(std::string) + p.capacity();
+    return bytes;
+}
+
+void CompressedColumns::clear() {
+    rows_ = 0;
+    times_.clear();
+    timeRuns_.clear();
+    products_.clear();
+    productBits_ = 0;
+    productCodes_.clear();
+    askBits_.clear();
+    prices_.clear();
+    amounts_.clear();
+}
@@ -0,0 +1,178 @@
+/*
+ * ConsolidatedBook.cpp — loser-tree merge of venue streams, incremental consolidated levels (see ConsolidatedBook.h).
+ *
+ * PURPOSE: load() reads every venue's CSV line by line (CSVReader::parseLine), merges the heads with a
+ * LoserTree, and feeds each order to its venue's OrderBook and to the live consolidated levels.
+ * Snapshots are frozen whenever the merged stream moves to a new timestamp.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-loading.md — Multi-venue loading and the consolidated book.
+ *
+ * BUILD: Linked into MerkelMain's build. Compile with -Isrc -pthread.
+ */
+
+#include "ConsolidatedBook.h"
+#include "CSVReader.h"
+#include "LoserTree.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace {
+    /** One venue's CSV as a stream of parsed orders; head is valid while !done. */
+    struct VenueStream {
+        std::ifstream file;
+        OrderBookEntry head;
+        bool done{true};
+
+        void advance() {
+            std::string line;
+            while (std::getline(file, line)) {
+                if (CSVReader::parseLine(line, head)) return;
+            }
+            done = true;
+        }
+    };
+}
+
+// -------- load: k-way merge of the venue streams --------
+
+std::size_t ConsolidatedBook::load(const std::vector<Source>& sources) {
+    venues_.clear();
+    books_.clear();
+    live_.clear();
+    snapshots_.clear();
+    times_.clear();
+    venueTime_.assign(sources.size(), std::string());
+    venueLevels_.assign(sources.size(), std::vector<VenueContribution>());
+
+    std::vector<VenueStream> streams(sources.size());
+    for (std::size_t v = 0; v < sources.size(); ++v) {
+        venues_.push_back(sources[v].venue);
+        books_.push_back(std::make_unique<OrderBook>());
+        streams[v].file.open(sources[v].filename);
+        if (!streams[v].file.is_open()) {
+            std::cerr << "Could not open venue file: " << sources[v].filename << std::endl;
+            continue;
+        }
+        streams[v].done = false;
+        streams[v].advance();
+    }
+
+    // Timestamp strings sort chronologically (fixed-width format); equal times go to the lower venue.
+    auto beats = [&streams](std::size_t a, std::size_t b) {
+        if (streams[a].done || streams[b].done) return !streams[a].done && streams[b].done;
+        const int byTime = streams[a].head.timestamp.compare(streams[b].head.timestamp);
+        return byTime != 0 ? byTime < 0 : a < b;
+    };
+    LoserTree<decltype(beats)> tree(streams.size(), beats);
+
+    std::size_t merged = 0;
+    while (!streams.empty() && !streams[tree.winner()].done) {
+        const std::size_t v = tree.winner();
+        const OrderBookEntry& e = streams[v].head;
+        if (times_.empty() || times_.back() != e.timestamp) {
+            if (!times_.empty()) snapshotDirty(times_.back());
+            times_.push_back(e.timestamp);
+        }
+        books_[v]->insertOrder(e);
+        apply(static_cast<std::uint32_t>(v), e);
+        ++merged;
+        streams[v].advance();
+        tree.replay();
+    }
+    if (!times_.empty()) snapshotDirty(times_.back());
+
+    for (auto& book : books_) {  // what OrderBook::load does after its own inserts
+        book->freezeTimeAxis();
+        book->buildRangeStats();
+    }
+    return merged;
+}
+
+// -------- Incremental consolidated levels --------
+
+void ConsolidatedBook::apply(std::uint32_t venue, const OrderBookEntry& e) {
+    if (venueTime_[venue] != e.timestamp) {
+        dropVenue(venue);  // the venue's new timestamp is its whole book: its older levels go
+        venueTime_[venue] = e.timestamp;
+    }
+    LiveProduct& live = live_[e.product];
+    const LevelKey key{e.price, venue};
+    bool added;
+    if (e.orderType == OrderBookType::bid) {
+        auto level = live.bids.try_emplace(key, 0.0);
+        level.first->second += e.amount;
+        added = level.second;
+    } else {
+        auto level = live.asks.try_emplace(key, 0.0);
+        level.first->second += e.amount;
+        added = level.second;
+    }
+    if (added) venueLevels_[venue].push_back({&live, e.orderType, e.price});  // a new level: remember it for dropVenue
+    live.dirty = true;
+}
+
+void ConsolidatedBook::dropVenue(std::uint32_t venue) {
+    for (const VenueContribution& c : venueLevels_[venue]) {
+        const LevelKey key{c.price, venue};
+        if (c.side == OrderBookType::bid) {
+            c.live->bids.erase(key);
+        } else {
+            c.live->asks.erase(key);
+        }
+        c.live->dirty = true;
+    }
+    venueLevels_[venue].clear();
+}
+
+void ConsolidatedBook::snapshotDirty(const std::string& time) {
+    for (auto& kv : live_) {
+        LiveProduct& live = kv.second;
+        if (!live.dirty) continue;
+        Snapshot& snap = snapshots_[{kv.first, time}];
+        snap.bids.clear();
+        snap.asks.clear();
+        for (const auto& level : live.bids) snap.bids.push_back({level.first.price, level.second, level.first.venue});
+        for (const auto& level : live.asks) snap.asks.push_back({level.first.price, level.second, level.first.venue});
+        live.dirty = false;
+    }
+}
+
+// -------- Queries: last snapshot at or before time --------
+
+const ConsolidatedBook::Snapshot* ConsolidatedBook::snapshotAt(const std::string& product, const std::string& time) const {
+    auto it = snapshots_.upper_bound({product, time});
+    if (it == snapshots_.begin()) return nullptr;
+    --it;
+    return (it->first.first == product) ? &it->second : nullptr;
+}
+
+const OrderBook* ConsolidatedBook::getVenueBook(std::size_t venue) const {
+    return (venue < books_.size()) ? books_[venue].get() : nullptr;
+}
+
+std::vector<std::string> ConsolidatedBook::getKnownProducts() const {
+    std::vector<std::string> products;
+    for (const auto& kv : live_) products.push_back(kv.first);
+    return products;
+}
+
+VenueLevel ConsolidatedBook::getBestBid(const std::string& product, const std::string& time) const {
+    const Snapshot* snap = snapshotAt(product, time);
+    return (snap && !snap->bids.empty()) ? snap->bids.front() : VenueLevel{};
+}
+
+VenueLevel ConsolidatedBook::getBestAsk(const std::string& product, const std::string& time) const {
+    const Snapshot* snap = snapshotAt(product, time);
+    return (snap && !snap->asks.empty()) ? snap->asks.front() : VenueLevel{};
+}
+
+std::vector<VenueLevel> ConsolidatedBook::getDepth(OrderBookType type, const std::string& product,
+                                                   const std::string& time, std::size_t maxLevels) const {
+    const Snapshot* snap = snapshotAt(product, time);
+    if (!snap) return {};
+    const std::vector<VenueLevel>& side = (type == OrderBookType::bid) ? snap->bids : snap->asks;
+    return std::vector<VenueLevel>(side.begin(), side.begin() + std::min(maxLevels, side.size()));
+}
@@ -0,0 +1,138 @@
+/*
+ * ConsolidatedBook.h — one book per product across several venues, levels tagged by venue.
+ *
+ * PURPOSE: The same products trade on several venues, each exported as its own time-sorted CSV in the
+ * usual format. A consolidated view answers "best bid anywhere, and where?" and shows every venue's
+ * depth side by side. Concatenating the files and re-sorting would need all of them in memory at once;
+ * instead the files are read as streams and merged on the fly.
+ *
+ * DESIGN:
+ *   - load(): one line reader per venue; a LoserTree merges their heads by (timestamp, venue index),
+ *     so the output is one global, time-ordered stream in O(log k) comparisons per order.
+ *   - Each venue keeps its own OrderBook underneath (every order goes through its insertOrder), so all
+ *     single-venue queries still work via getVenueBook().
+ *   - The consolidated levels are built incrementally from the merged stream. A venue's orders at a
+ *     timestamp are its whole book, as in a single-venue OrderBook: when venue v reaches a new
+ *     timestamp, v's previous levels are dropped and the new ones build up. The other venues' levels
+ *     stay, so at any time the book shows each venue's latest snapshot. Each venue remembers the
+ *     (product, level) entries it added, so dropping them costs the venue's own levels, not a walk of
+ *     every product's book. When the merged stream moves
+ *     past a timestamp, every product that changed at it is frozen into a sorted snapshot.
+ *   - Queries at time t use the last snapshot at or before t: one map lookup, no merge at query time.
+ *   - Tradeoff: a snapshot per (product, merged timestamp) costs memory proportional to depth × time;
+ *     the venue books hold the orders themselves.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-loading.md — Multi-venue loading and the consolidated book.
+ *   docs/trading-market-basics.md — Best bid/ask, depth.
+ *
+ * USE: Include "ConsolidatedBook.h"; link ConsolidatedBook.cpp (and OrderBook's sources). Load, then
+ * query from one thread (the venue books themselves are thread-safe). Build with -Isrc -pthread.
+ */
+
+#pragma once
+
+#include "OrderBook.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** Amount resting at one price on one venue. */
+struct VenueLevel {
+    double price{0.0};
+    double amount{0.0};
+    std::uint32_t venue{0};  /** index into getVenues() */
+};
+
+class ConsolidatedBook {
+public:
+    /** One input: venue name and its CSV (same format as OrderBook, sorted by timestamp). */
+    struct Source {
+        std::string venue;
+        std::string filename;
+    };
+
+    /** Replace the book with the k-way merge of sources. A file that cannot be opened is logged and its
+        venue stays empty. Returns the number of orders merged. */
+    std::size_t load(const std::vector<Source>& sources);
+
+    const std::vector<std::string>& getVenues() const { return venues_; }
+
+    /** The single-venue OrderBook behind venue (index into getVenues()); null if out of range. */
+    const OrderBook* getVenueBook(std::size_t venue) const;
+
+    /** Products seen on any venue, sorted. */
+    std::vector<std::string> getKnownProducts() const;
+
+    /** Merged timestamps (every timestamp of any venue), ascending. */
+    const std::vector<std::string>& getTimes() const { return times_; }
+
+    /** Best bid / ask across venues at time: each venue's latest book <= time. price 0.0 if none;
+        on equal prices the lower venue index wins. */
+    VenueLevel getBestBid(const std::string& product, const std::string& time) const;
+    VenueLevel getBestAsk(const std::string& product, const std::string& time) const;
+
+    /** Consolidated levels of one side, best first, one entry per (price, venue), at most maxLevels. */
+    std::vector<VenueLevel> getDepth(OrderBookType type, const std::string& product, const std::string& time,
+                                     std::size_t maxLevels) const;
+
+private:
+    using ProductTime = std::pair<std::string, std::string>;
+
+    /** Live level key: bids sort price high→low, asks low→high; then venue. */
+    struct LevelKey {
+        double price;
+        std::uint32_t venue;
+    };
+    struct BidsFirst {
+        bool operator()(const LevelKey& a, const LevelKey& b) const {
+            return a.price != b.price ? a.price > b.price : a.venue < b.venue;
+        }
+    };
+    struct AsksFirst {
+        bool operator()(const LevelKey& a, const LevelKey& b) const {
+            return a.price != b.price ? a.price < b.price : a.venue < b.venue;
+        }
+    };
+
+    /** Consolidated state of one product while the merge runs. */
+    struct LiveProduct {
+        std::map<LevelKey, double, BidsFirst> bids;
+        std::map<LevelKey, double, AsksFirst> asks;
+        bool dirty{false};  /** changed since the last snapshot */
+    };
+
+    /** One live level a venue contributed: live_ entries never move, so the pointer stays valid. */
+    struct VenueContribution {
+        LiveProduct* live;
+        OrderBookType side;
+        double price;
+    };
+
+    /** Frozen consolidated levels, best first. */
+    struct Snapshot {
+        std::vector<VenueLevel> bids;
+        std::vector<VenueLevel> asks;
+    };
+
+    /** Apply one merged order: drop the venue's older levels if it moved to a new timestamp, then add it. */
+    void apply(std::uint32_t venue, const OrderBookEntry& e);
+    /** Remove every live level of venue (all products): only the ones it contributed, not a full walk. */
+    void dropVenue(std::uint32_t venue);
+    /** Freeze every dirty product's levels as its snapshot at time. */
+    void snapshotDirty(const std::string& time);
+    /** Last snapshot of product at or before time; null if none. */
+    const Snapshot* snapshotAt(const std::string& product, const std::string& time) const;
+
+    std::vector<std::string> venues_;
+    std::vector<std::unique_ptr<OrderBook>> books_;
+    std::map<std::string, LiveProduct> live_;
+    std::map<ProductTime, Snapshot> snapshots_;
+    std::vector<std::string> times_;
+    std::vector<std::string> venueTime_;  /** per venue: timestamp its live levels are from */
+    std::vector<std::vector<VenueContribution>> venueLevels_;  /** per venue: its live levels, one entry each */
+};
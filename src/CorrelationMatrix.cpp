@@ -0,0 +1,189 @@
+/*
+ * CorrelationMatrix.cpp — co-moment updates in row bands and column blocks (see CorrelationMatrix.h).
+ *
+ * PURPOSE: addSteps turns mids into returns, pairs each new row with the row leaving the window, and
+ * hands the batch to one worker per row band; recompute() rebuilds the sums from the ring.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-statistics.md — Cross-product correlations.
+ *
+ * BUILD: Linked into MerkelMain's build. Compile with -Isrc -pthread. The AVX2 row update is picked at
+ * run time (BitOps::hasAvx2), so no -mavx2 is needed.
+ */
+
+#include "CorrelationMatrix.h"
+#include "BitOps.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+    constexpr std::size_t kColumnBlock = 512;          /** columns of one row kept in L1 across a batch */
+    constexpr std::size_t kMinWorkPerThread = 1u << 16; /** multiply-adds below which a thread is not worth it */
+
+#if BITOPS_AVX2
+    /** updateTail over [0, n rounded down to 4); returns the first column not updated. Same operations
+        per element as the scalar loop (no FMA), so both paths give identical sums. */
+    BITOPS_TARGET_AVX2 std::size_t updateTailAvx2(double* q, double a, const double* x, double b, const double* y,
+                                                  std::size_t n) {
+        std::size_t j = 0;
+        const __m256d va = _mm256_set1_pd(a), vb = _mm256_set1_pd(b);
+        for (; j + 4 <= n; j += 4) {
+            const __m256d add = _mm256_mul_pd(va, _mm256_loadu_pd(x + j));
+            const __m256d sub = _mm256_mul_pd(vb, _mm256_loadu_pd(y + j));
+            _mm256_storeu_pd(q + j, _mm256_add_pd(_mm256_loadu_pd(q + j), _mm256_sub_pd(add, sub)));
+        }
+        return j;
+    }
+#endif
+
+    /** q[0 .. n) += a * x[0 .. n) - b * y[0 .. n). */
+    void updateTail(double* q, double a, const double* x, double b, const double* y, std::size_t n) {
+        std::size_t j = 0;
+#if BITOPS_AVX2
+        if (BitOps::hasAvx2()) j = updateTailAvx2(q, a, x, b, y, n);
+#endif
+        for (; j < n; ++j) q[j] += a * x[j] - b * y[j];
+    }
+}
+
+CorrelationMatrix::CorrelationMatrix(const std::vector<std::string>& products, std::size_t window, unsigned threads)
+    : products_(products), window_(std::max<std::size_t>(window, 2)), threads_(threads) {
+    if (threads_ == 0) threads_ = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t i = 0; i < products_.size(); ++i) index_[products_[i]] = i;
+    const std::size_t n = products_.size();
+    stride_ = (n + 3) & ~std::size_t{3};
+    lastMid_.assign(n, 0.0);
+    ring_.assign(window_ * stride_, 0.0);
+    sum_.assign(n, 0.0);
+    q_.assign(n * stride_, 0.0);
+}
+
+// -------- Feeding steps --------
+
+void CorrelationMatrix::toReturns(const double* mids, double* returns) {
+    for (std::size_t i = 0; i < products_.size(); ++i) {
+        const double mid = mids[i];
+        returns[i] = (mid > 0.0 && lastMid_[i] > 0.0) ? std::log(mid / lastMid_[i]) : 0.0;
+        if (mid > 0.0) lastMid_[i] = mid;
+    }
+}
+
+void CorrelationMatrix::addStep(const std::vector<double>& mids) {
+    addSteps(mids, 1);
+}
+
+void CorrelationMatrix::addSteps(const std::vector<double>& mids, std::size_t steps) {
+    const std::size_t n = products_.size();
+    if (n == 0 || steps == 0 || mids.size() < steps * n) return;
+
+    // Returns of the batch. The row leaving the window at step s is either still in the ring (untouched
+    // until the workers are done) or an earlier row of this same batch.
+    std::vector<double> batch(steps * stride_, 0.0);
+    std::vector<const double*> in(steps), out(steps);
+    for (std::size_t s = 0; s < steps; ++s) {
+        double* returns = batch.data() + s * stride_;
+        toReturns(mids.data() + s * n, returns);
+        in[s] = returns;
+        const std::size_t filledBefore = filled_ + s;  // window rows before step s
+        if (filledBefore < window_) {
+            out[s] = nullptr;
+        } else if (s >= window_) {
+            out[s] = batch.data() + (s - window_) * stride_;
+        } else {
+            out[s] = ring_.data() + ((head_ + s) % window_) * stride_;
+        }
+        for (std::size_t i = 0; i < n; ++i) sum_[i] += returns[i] - (out[s] ? out[s][i] : 0.0);
+    }
+    updateRows(in, out);
+
+    for (std::size_t s = (steps > window_ ? steps - window_ : 0); s < steps; ++s) {
+        std::copy(in[s], in[s] + stride_, ring_.begin() + static_cast<std::ptrdiff_t>(((head_ + s) % window_) * stride_));
+    }
+    head_ = (head_ + steps) % window_;
+    filled_ = std::min(window_, filled_ + steps);
+    sinceRecompute_ += steps;
+    if (sinceRecompute_ >= window_) recompute();
+}
+
+void CorrelationMatrix::addTimeStep(const std::vector<SummaryRow>& rows) {
+    std::vector<double> mids(products_.size(), 0.0);
+    for (const SummaryRow& row : rows) {
+        auto it = index_.find(row.product);
+        if (it != index_.end() && row.bestBid > 0.0 && row.bestAsk > 0.0) mids[it->second] = (row.bestBid + row.bestAsk) / 2.0;
+    }
+    addStep(mids);
+}
+
+// -------- Co-moment update: row bands (threads) × column blocks (cache) × steps --------
+
+void CorrelationMatrix::updateRows(const std::vector<const double*>& in, const std::vector<const double*>& out) {
+    const std::size_t n = products_.size();
+    const std::size_t steps = in.size();
+    static const double zeros[kColumnBlock] = {};  // stands in for a missing leaving row (one block at a time)
+
+    auto band = [&](std::size_t rowBegin, std::size_t rowEnd) {
+        for (std::size_t i = rowBegin; i < rowEnd; ++i) {
+            double* qi = q_.data() + i * stride_;
+            for (std::size_t j0 = i; j0 < n; j0 += kColumnBlock) {
+                const std::size_t len = std::min(kColumnBlock, n - j0);
+                for (std::size_t s = 0; s < steps; ++s) {
+                    const double* o = out[s] ? out[s] + j0 : zeros;
+                    updateTail(qi + j0, in[s][i], in[s] + j0, out[s] ? out[s][i] : 0.0, o, len);
+                }
+            }
+        }
+    };
+
+    // Bands of about equal triangle area: row i holds n - i entries.
+    const std::size_t work = n * (n + 1) / 2 * steps;
+    const std::size_t workers = std::max<std::size_t>(1, std::min<std::size_t>(threads_, work / kMinWorkPerThread));
+    std::vector<std::size_t> bandStart(1, 0);
+    const std::size_t area = n * (n + 1) / 2;
+    std::size_t done = 0;
+    for (std::size_t i = 0; i < n && bandStart.size() < workers; ++i) {
+        done += n - i;
+        if (done * workers >= area * bandStart.size()) bandStart.push_back(i + 1);
+    }
+    bandStart.push_back(n);
+
+    std::vector<std::thread> pool;
+    for (std::size_t b = 1; b + 1 < bandStart.size(); ++b) pool.emplace_back(band, bandStart[b], bandStart[b + 1]);
+    band(bandStart[0], bandStart[1]);
+    for (std::thread& t : pool) t.join();
+}
+
+void CorrelationMatrix::recompute() {
+    std::fill(sum_.begin(), sum_.end(), 0.0);
+    std::fill(q_.begin(), q_.end(), 0.0);
+    std::vector<const double*> rows(filled_), none(filled_, nullptr);
+    for (std::size_t s = 0; s < filled_; ++s) {
+        rows[s] = ring_.data() + s * stride_;
+        for (std::size_t i = 0; i < products_.size(); ++i) sum_[i] += rows[s][i];
+    }
+    updateRows(rows, none);
+    sinceRecompute_ = 0;
+}
+
+// -------- Reading --------
+
+double CorrelationMatrix::correlation(std::size_t i, std::size_t j) const {
+    const std::size_t n = products_.size();
+    if (i >= n || j >= n || filled_ < 2) return 0.0;
+    if (i > j) std::swap(i, j);
+    const double count = static_cast<double>(filled_);
+    const double vi = count * q_[i * stride_ + i] - sum_[i] * sum_[i];
+    const double vj = count * q_[j * stride_ + j] - sum_[j] * sum_[j];
+    if (!(vi > 0.0) || !(vj > 0.0)) return 0.0;
+    const double c = (count * q_[i * stride_ + j] - sum_[i] * sum_[j]) / std::sqrt(vi * vj);
+    return std::max(-1.0, std::min(1.0, c));
+}
+
+std::vector<double> CorrelationMatrix::matrix() const {
+    const std::size_t n = products_.size();
+    std::vector<double> out(n * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = i; j < n; ++j) out[i * n + j] = out[j * n + i] = correlation(i, j);
+    }
+    return out;
+}
@@ -0,0 +1,89 @@
+/*
+ * CorrelationMatrix.h — rolling N×N correlations of mid-price returns across products, updated per
+ * time step from incremental co-moment sums.
+ *
+ * PURPOSE: "Which products move together, lately?" By hand that is per-product getOrders calls, a
+ * return series per product, then a fresh O(N² W) pass over the window for every step. With hundreds
+ * of products that does not scale. CorrelationMatrix keeps the window's sums so a step costs O(N²)
+ * small, vectorized multiply-adds, spread over cores.
+ *
+ * DESIGN:
+ *   - Per step every product gets a return r_i = ln(mid / previous mid); a product without a quote at
+ *     the step (or before its first quote) gets 0 (its last mid carries forward). A ring buffer keeps
+ *     the last `window` return rows.
+ *   - Co-moments over the window: S_i = sum r_i and Q_ij = sum r_i r_j (upper triangle, j >= i). A step
+ *     adds the new outer product and subtracts the one leaving the window:
+ *     Q_ij += r_i r_j - o_i o_j — for row i an axpy over the contiguous tail j >= i, four lanes at a
+ *     time on CPUs with AVX2 (checked at run time). corr_ij = (n Q_ij - S_i S_j) / sqrt((n Q_ii - S_i²)(n Q_jj - S_j²)).
+ *   - Blocked and parallel: addSteps() takes a batch of steps. Workers own bands of rows balanced by
+ *     triangle area; each walks its rows in column blocks and applies every step of the batch to a block
+ *     while it is in cache. Bands are disjoint, so there are no locks.
+ *   - Drift: adding and subtracting lets rounding error build up, so once per `window` steps the sums
+ *     are recomputed from the ring (same bands, same kernel; O(N²) amortized per step).
+ *   - Tradeoff: O(N² + W N) memory (N = 1000 is 8 MB for Q); returns of missing quotes count as 0
+ *     instead of being excluded pairwise.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-statistics.md — Cross-product correlations.
+ *
+ * USE: Include "CorrelationMatrix.h"; link CorrelationMatrix.cpp. Not thread-safe itself (it runs its
+ * own workers). Build with -Isrc -pthread.
+ */
+
+#pragma once
+
+#include "SummaryTable.h"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+class CorrelationMatrix {
+public:
+    /** products fixes the row / column order; window = return steps per correlation (>= 2);
+        threads = 0 uses hardware_concurrency. */
+    CorrelationMatrix(const std::vector<std::string>& products, std::size_t window, unsigned threads = 0);
+
+    /** One step: mids[i] for products[i]; a value <= 0 means no quote at this step. */
+    void addStep(const std::vector<double>& mids);
+
+    /** steps consecutive steps, row-major (steps × productCount() mids). Faster than one addStep each:
+        the workers apply the whole batch to their rows in one pass. */
+    void addSteps(const std::vector<double>& mids, std::size_t steps);
+
+    /** One replay step from OrderBook::getSummariesAtTime (mid = (bestBid + bestAsk) / 2 when both sides
+        exist; unknown products ignored). */
+    void addTimeStep(const std::vector<SummaryRow>& rows);
+
+    /** Correlation of products i and j over the window; 0.0 if either has no variance (or no data yet). */
+    double correlation(std::size_t i, std::size_t j) const;
+
+    /** All correlations, row-major N×N (diagonal 1.0 where the product has variance). */
+    std::vector<double> matrix() const;
+
+    const std::vector<std::string>& getProducts() const { return products_; }
+    std::size_t productCount() const { return products_.size(); }
+    /** Return steps in the current window (<= window). */
+    std::size_t sampleCount() const { return filled_; }
+
+private:
+    /** Turn one row of mids into returns (updating lastMid_). */
+    void toReturns(const double* mids, double* returns);
+    /** Q[i][j >= i] += sum over steps of in[s][i] * in[s][j] - out[s][i] * out[s][j] (out may be null). */
+    void updateRows(const std::vector<const double*>& in, const std::vector<const double*>& out);
+    /** Re-accumulate S and Q from the ring (cancels drift). */
+    void recompute();
+
+    std::vector<std::string> products_;
+    std::map<std::string, std::size_t> index_;
+    std::size_t window_;
+    unsigned threads_;
+    std::size_t stride_;           /** row stride of q_ and ring_ (N rounded up to 4) */
+    std::vector<double> lastMid_;  /** per product; 0 before its first quote */
+    std::vector<double> ring_;     /** window_ rows of returns */
+    std::size_t head_{0};          /** ring row the next step overwrites */
+    std::size_t filled_{0};
+    std::size_t sinceRecompute_{0};
+    std::vector<double> sum_;      /** S_i */
+    std::vector<double> q_;        /** Q, row-major with stride_, upper triangle used */
+};
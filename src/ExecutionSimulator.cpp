@@ -0,0 +1,120 @@
+/*
+ * ExecutionSimulator.cpp — schedule, child fills, benchmarks and the parallel driver (see
+ * ExecutionSimulator.h).
+ *
+ * PURPOSE: simulate() finds the parent's steps, cuts them into runs, sizes each child from the
+ * cumulative schedule and walks the opposite side; simulateAll() spreads parents over threads.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-matching.md — Execution simulation (TWAP / VWAP).
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc -pthread.
+ */
+
+#include "ExecutionSimulator.h"
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace {
+    /** Take up to amount from levels (best first) without passing limit (0 = none). */
+    void takeLiquidity(const std::vector<PriceLevel>& levels, bool buying, double limit, ChildFill& child) {
+        double remaining = child.target;
+        for (const PriceLevel& level : levels) {
+            if (remaining <= 0.0) break;
+            if (limit > 0.0 && (buying ? level.price > limit : level.price < limit)) break;
+            const double take = std::min(remaining, level.amount);
+            child.filled += take;
+            child.notional += take * level.price;
+            remaining -= take;
+        }
+    }
+}
+
+void ExecutionSimulator::addStep(const std::string& product, ExecutionStep step) {
+    steps_[product].push_back(std::move(step));
+}
+
+// -------- One parent: window → runs → children --------
+
+ExecutionReport ExecutionSimulator::simulate(const ParentOrder& parent) const {
+    ExecutionReport report;
+    report.requested = std::max(parent.amount, 0.0);
+    report.side = parent.side;
+    auto product = steps_.find(parent.product);
+    if (product == steps_.end() || !(report.requested > 0.0)) return report;
+
+    const std::vector<ExecutionStep>& all = product->second;
+    auto timeLess = [](const ExecutionStep& step, const std::string& t) { return step.timestamp < t; };
+    auto first = parent.from.empty() ? all.begin() : std::lower_bound(all.begin(), all.end(), parent.from, timeLess);
+    auto last = parent.to.empty() ? all.end()
+                                  : std::upper_bound(first, all.end(), parent.to,
+                                                     [](const std::string& t, const ExecutionStep& step) { return t < step.timestamp; });
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    if (n == 0) return report;
+
+    // Benchmarks over every step of the window.
+    double midSum = 0.0, weightedMid = 0.0, midVolume = 0.0;
+    std::size_t mids = 0;
+    for (auto it = first; it != last; ++it) {
+        const double mid = it->mid();
+        if (!(mid > 0.0)) continue;
+        if (mids++ == 0) report.arrivalMid = mid;
+        midSum += mid;
+        weightedMid += mid * it->volume;
+        midVolume += it->volume;
+    }
+    report.twapMid = mids ? midSum / static_cast<double>(mids) : 0.0;
+    report.vwapMid = (midVolume > 0.0) ? weightedMid / midVolume : report.twapMid;
+
+    // Runs of steps, one child each, and their schedule weights.
+    const std::size_t runs = (parent.slices == 0) ? n : std::min(parent.slices, n);
+    std::vector<double> weights(runs, 1.0);
+    if (parent.style == ExecutionStyle::vwap) {
+        double total = 0.0;
+        for (std::size_t r = 0; r < runs; ++r) {
+            double volume = 0.0;
+            for (std::size_t i = r * n / runs; i < (r + 1) * n / runs; ++i) volume += first[i].volume;
+            weights[r] = volume;
+            total += volume;
+        }
+        if (!(total > 0.0)) std::fill(weights.begin(), weights.end(), 1.0);  // no volume anywhere: fall back to TWAP
+    }
+    double totalWeight = 0.0;
+    for (double w : weights) totalWeight += w;
+
+    const bool buying = (parent.side == OrderBookType::bid);
+    double cumulative = 0.0;
+    report.children.reserve(runs);
+    for (std::size_t r = 0; r < runs; ++r) {
+        const ExecutionStep& step = first[r * n / runs];
+        cumulative += weights[r];
+        const double due = (r + 1 == runs) ? report.requested : report.requested * cumulative / totalWeight;
+        ChildFill child;
+        child.timestamp = step.timestamp;
+        child.target = std::max(due - report.filled, 0.0);
+        takeLiquidity(buying ? step.asks : step.bids, buying, parent.limitPrice, child);
+        report.filled += child.filled;
+        report.notional += child.notional;
+        report.children.push_back(std::move(child));
+    }
+    return report;
+}
+
+// -------- Many parents: contiguous slices, one thread each --------
+
+std::vector<ExecutionReport> ExecutionSimulator::simulateAll(const std::vector<ParentOrder>& parents, unsigned threads) const {
+    std::vector<ExecutionReport> reports(parents.size());
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t workers = std::max<std::size_t>(1, std::min<std::size_t>(threads, parents.size()));
+    auto slice = [&](std::size_t w) {
+        for (std::size_t i = w * parents.size() / workers; i < (w + 1) * parents.size() / workers; ++i) {
+            reports[i] = simulate(parents[i]);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (std::size_t w = 1; w < workers; ++w) pool.emplace_back(slice, w);
+    slice(0);
+    for (std::thread& t : pool) t.join();
+    return reports;
+}
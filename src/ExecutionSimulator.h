@@ -0,0 +1,114 @@
+/*
+ * ExecutionSimulator.h — replay TWAP / VWAP parent orders against the historical book: slice each into
+ * child orders, fill every child against the depth at its timestamp, and compare the average fill
+ * price with the arrival, TWAP and VWAP benchmarks.
+ *
+ * PURPOSE: "What would a 50-lot buy spread over the afternoon have cost?" MerkelMain only takes one
+ * hand-typed bid or ask at a time, and a strategy study needs thousands of parent orders (sizes,
+ * windows, schedules) against the same history.
+ *
+ * DESIGN:
+ *   - Market data: OrderBook::simulateExecutions copies, under its lock, the aggregated depth of every
+ *     (product, timestamp) the parents' windows touch into ExecutionSteps (levels best first, mid,
+ *     resting volume). The simulator then only reads that copy, so any number of workers run without
+ *     a lock and the book stays free for the menu thread.
+ *   - Schedule: the window's timestamps are split into `slices` runs of about equal length (0 = one
+ *     per timestamp); a child is sent at the first timestamp of each run. TWAP weights the runs
+ *     equally; VWAP weights them by resting volume (bid + ask) over the run — the data holds orders,
+ *     not trades, so resting volume stands in for the traded-volume profile. A child's target is the
+ *     schedule's cumulative amount minus what has filled, so a shortfall rolls into the next child.
+ *   - Fill: a child takes the opposite side best level first, up to limitPrice if set. It is filled
+ *     against the snapshot only: the history does not react, so children and parent orders never
+ *     compete for the same liquidity (no market impact).
+ *   - Benchmarks: arrival mid (first step with both sides), TWAP mid (mean over the window's steps) and
+ *     VWAP mid (weighted by resting volume). slippageBps is signed so that positive = worse than the
+ *     benchmark for the parent's side.
+ *   - Parallel: parents are cut into contiguous slices, one std::thread each; reports go into their
+ *     own slots of a presized vector.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-matching.md — Execution simulation (TWAP / VWAP).
+ *
+ * USE: Include "ExecutionSimulator.h"; link ExecutionSimulator.cpp. Call
+ * OrderBook::simulateExecutions(parents, threads). Build with -Isrc -pthread.
+ */
+
+#pragma once
+
+#include "OrderBookEntry.h"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+enum class ExecutionStyle { twap, vwap };
+
+/** One parent order to work. side = bid buys (takes asks); side = ask sells (takes bids). */
+struct ParentOrder {
+    std::string product;
+    OrderBookType side{OrderBookType::bid};
+    double amount{0.0};
+    std::string from;      /** window; empty = from the product's first / to its last timestamp */
+    std::string to;
+    ExecutionStyle style{ExecutionStyle::twap};
+    std::size_t slices{0};  /** child orders; 0 = one per timestamp in the window */
+    double limitPrice{0.0}; /** worst price a child may take (buy: highest, sell: lowest); 0 = none */
+};
+
+/** One child order and what it got. */
+struct ChildFill {
+    std::string timestamp;
+    double target{0.0};
+    double filled{0.0};
+    double notional{0.0};  /** sum of price * amount over the levels taken */
+};
+
+/** Outcome of one parent order. */
+struct ExecutionReport {
+    double requested{0.0};
+    double filled{0.0};
+    double notional{0.0};
+    double arrivalMid{0.0};  /** 0.0 if the window never had both sides */
+    double twapMid{0.0};
+    double vwapMid{0.0};
+    OrderBookType side{OrderBookType::bid};
+    std::vector<ChildFill> children;
+
+    /** Volume-weighted fill price; 0.0 if nothing filled. */
+    double averagePrice() const { return (filled > 0.0) ? notional / filled : 0.0; }
+    double fillRate() const { return (requested > 0.0) ? filled / requested : 0.0; }
+    /** Cost against benchmark in basis points: positive = paid more (buy) / received less (sell). 0.0 if
+        nothing filled or no benchmark. */
+    double slippageBps(double benchmark) const {
+        if (!(filled > 0.0) || !(benchmark > 0.0)) return 0.0;
+        const double diff = (side == OrderBookType::bid) ? averagePrice() - benchmark : benchmark - averagePrice();
+        return diff / benchmark * 10000.0;
+    }
+};
+
+/** One (product, timestamp) of the copied market. */
+struct ExecutionStep {
+    std::string timestamp;
+    std::vector<PriceLevel> bids;  /** best (highest) first */
+    std::vector<PriceLevel> asks;  /** best (lowest) first */
+    double volume{0.0};            /** resting bid + ask amount */
+
+    /** (best bid + best ask) / 2; 0.0 unless both sides are present. */
+    double mid() const { return (!bids.empty() && !asks.empty()) ? (bids.front().price + asks.front().price) / 2.0 : 0.0; }
+};
+
+class ExecutionSimulator {
+public:
+    /** Add product's next step; steps of a product must arrive in ascending time. */
+    void addStep(const std::string& product, ExecutionStep step);
+
+    /** Work one parent order. */
+    ExecutionReport simulate(const ParentOrder& parent) const;
+
+    /** Work every parent with up to `threads` workers (0 = hardware_concurrency). One report per parent,
+        in the same order. */
+    std::vector<ExecutionReport> simulateAll(const std::vector<ParentOrder>& parents, unsigned threads) const;
+
+private:
+    std::map<std::string, std::vector<ExecutionStep>> steps_;
+};
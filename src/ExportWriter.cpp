@@ -0,0 +1,134 @@
+/*
+ * ExportWriter.cpp — std::to_chars row formatting and pwrite-based ordered writes (see ExportWriter.h).
+ *
+ * PURPOSE: appendCSV builds CSV text without streams; OrderedFileWriter places each round of buffers
+ * at consecutive offsets with one positional write per buffer (std::ofstream fallback on Windows).
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-loading.md — Exporting subsets.
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc -pthread.
+ */
+
+#include "ExportWriter.h"
+#include <charconv>
+#include <iostream>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    void appendNumber(std::string& out, double value) {
+        char text[32];
+        const std::to_chars_result r = std::to_chars(text, text + sizeof text, value);
+        out.append(text, r.ptr);
+    }
+
+#if !defined(_WIN32)
+    /** pwrite until all of buffer is on disk (pwrite may write less than asked). */
+    bool writeAt(int fd, const std::string& buffer, std::uint64_t offset) {
+        std::size_t done = 0;
+        while (done < buffer.size()) {
+            const ssize_t n = ::pwrite(fd, buffer.data() + done, buffer.size() - done,
+                                       static_cast<off_t>(offset + done));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+#endif
+}
+
+// -------- appendCSV --------
+
+std::size_t ExportWriter::appendCSV(std::string& out, const std::vector<OrderBookEntry>& entries, bool bids,
+                                    bool asks) {
+    std::size_t lines = 0;
+    for (const OrderBookEntry& e : entries) {
+        const bool isBid = (e.orderType == OrderBookType::bid);
+        if (isBid ? !bids : !asks) continue;
+        out.append(e.timestamp);
+        out.push_back(',');
+        out.append(e.product);
+        out.push_back(',');
+        out.append(orderBookTypeToString(e.orderType));
+        out.push_back(',');
+        appendNumber(out, e.amount);
+        out.push_back(',');
+        appendNumber(out, e.price);
+        out.push_back('\n');
+        ++lines;
+    }
+    return lines;
+}
+
+// -------- OrderedFileWriter --------
+
+OrderedFileWriter::~OrderedFileWriter() {
+    close();
+}
+
+bool OrderedFileWriter::open(const std::string& path) {
+    close();
+    path_ = path;
+    offset_ = 0;
+    failed_ = false;
+#if defined(_WIN32)
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    const bool opened = file_.is_open();
+#else
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    const bool opened = (fd_ >= 0);
+#endif
+    if (!opened) std::cerr << "Could not open export file: " << path << std::endl;
+    return opened;
+}
+
+bool OrderedFileWriter::write(const std::string* buffers, std::size_t count) {
+#if defined(_WIN32)
+    for (std::size_t i = 0; i < count; ++i) {
+        file_.write(buffers[i].data(), static_cast<std::streamsize>(buffers[i].size()));
+        offset_ += buffers[i].size();
+    }
+    failed_ = failed_ || !file_;
+#else
+    if (fd_ < 0) return false;
+    // Offsets come from the sizes, so the writes can run at the same time and still land in order.
+    std::vector<std::uint64_t> offsets(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        offsets[i] = offset_;
+        offset_ += buffers[i].size();
+    }
+    std::vector<char> ok(count, 1);
+    std::vector<std::thread> writers;
+    for (std::size_t i = 1; i < count; ++i) {
+        if (buffers[i].empty()) continue;
+        writers.emplace_back([&, i]() { ok[i] = writeAt(fd_, buffers[i], offsets[i]); });
+    }
+    if (count > 0) ok[0] = writeAt(fd_, buffers[0], offsets[0]);
+    for (std::thread& writer : writers) writer.join();
+    for (char written : ok) failed_ = failed_ || !written;
+#endif
+    if (failed_) std::cerr << "Write failed: " << path_ << std::endl;
+    return !failed_;
+}
+
+bool OrderedFileWriter::close() {
+#if defined(_WIN32)
+    if (file_.is_open()) {
+        file_.close();
+        failed_ = failed_ || file_.fail();
+    }
+#else
+    if (fd_ >= 0) {
+        failed_ = (::close(fd_) != 0) || failed_;
+        fd_ = -1;
+    }
+#endif
+    return !failed_;
+}
@@ -0,0 +1,326 @@
+/*
+ * ExternalSort.cpp — parallel sorted runs, one k-way heap merge, columnar output (see ExternalSort.h).
+ *
+ * PURPOSE: sortCSV reads the CSV once, hands ~runBytes chunks of lines to worker threads (parse + stable
+ * sort + write a run of BinaryIO blocks), then merges the runs into the columnar file. ColumnarView reads
+ * that file in place. When EXTERNALSORT_STANDALONE is defined, main() wraps sortCSV as a command-line tool.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-loading.md — External sort for huge unsorted CSVs.
+ *
+ * BUILD: scripts/build-ExternalSort.ps1. Compile with -Isrc -pthread.
+ */
+
+#include "ExternalSort.h"
+#include "BinaryIO.h"
+#include "CSVReader.h"
+#include "TimeKey.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <thread>
+#include <utility>
+
+static_assert(sizeof(ColumnarHeader) == 72, "columnar header layout");
+static_assert(sizeof(ColumnarPartition) == 56, "columnar partition layout");
+
+namespace {
+    constexpr std::uint32_t kColumnarMagic = 0x3143424F;  // "OBC1" little-endian
+    constexpr std::uint32_t kColumnarVersion = 1;
+    constexpr std::size_t kColumnBuffer = 1u << 20;  /** bytes buffered per column before a write */
+
+    std::uint64_t align8(std::uint64_t offset) { return (offset + 7) & ~std::uint64_t{7}; }
+
+    /** One run: a file of BinaryIO blocks sorted by (product, timestamp). Filled in by its worker. */
+    struct Run {
+        std::string path;
+        std::uint64_t rows{0};
+        bool ok{false};
+    };
+
+    // -------- Run phase: parse, stable sort, write one block per (product, timestamp) --------
+
+    void writeRun(std::vector<std::string> lines, Run& run) {
+        std::vector<OrderBookEntry> entries;
+        entries.reserve(lines.size());
+        OrderBookEntry entry;
+        for (const std::string& line : lines) {
+            if (CSVReader::parseLine(line, entry)) entries.push_back(std::move(entry));
+        }
+        std::vector<std::string>().swap(lines);  // free the text before the sorted copy is written
+        std::stable_sort(entries.begin(), entries.end(), [](const OrderBookEntry& a, const OrderBookEntry& b) {
+            const int byProduct = a.product.compare(b.product);
+            return byProduct != 0 ? byProduct < 0 : a.timestamp < b.timestamp;
+        });
+
+        std::ofstream out(run.path, std::ios::binary | std::ios::trunc);
+        std::vector<OrderBookEntry> block;
+        for (std::size_t i = 0; i < entries.size();) {
+            std::size_t j = i;
+            while (j < entries.size() && entries[j].product == entries[i].product &&
+                   entries[j].timestamp == entries[i].timestamp) ++j;
+            block.assign(std::make_move_iterator(entries.begin() + i), std::make_move_iterator(entries.begin() + j));
+            BinaryIO::writePartition(out, block.front().product, block.front().timestamp, block);
+            i = j;
+        }
+        run.rows = entries.size();
+        run.ok = static_cast<bool>(out);
+    }
+
+    // -------- Merge phase: one cursor per run, smallest (product, timestamp, run) first --------
+
+    struct Cursor {
+        std::ifstream in;
+        std::size_t run{0};
+        std::string product;
+        std::string timestamp;
+        std::vector<OrderBookEntry> block;
+
+        bool next() { return BinaryIO::readPartition(in, product, timestamp, block); }
+    };
+
+    struct CursorAfter {
+        bool operator()(const Cursor* a, const Cursor* b) const {
+            const int byProduct = a->product.compare(b->product);
+            if (byProduct != 0) return byProduct > 0;
+            const int byTime = a->timestamp.compare(b->timestamp);
+            return byTime != 0 ? byTime > 0 : a->run > b->run;
+        }
+    };
+
+    /** Buffered writer for one column at a fixed region of the output file. */
+    class ColumnWriter {
+    public:
+        explicit ColumnWriter(std::uint64_t offset) : offset_(offset) { buffer_.reserve(kColumnBuffer); }
+
+        template <typename T>
+        void put(std::fstream& file, const T& value) {
+            const char* bytes = reinterpret_cast<const char*>(&value);
+            buffer_.insert(buffer_.end(), bytes, bytes + sizeof value);
+            if (buffer_.size() >= kColumnBuffer) flush(file);
+        }
+
+        void flush(std::fstream& file) {
+            if (buffer_.empty()) return;
+            file.seekp(static_cast<std::streamoff>(offset_));
+            file.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+            offset_ += buffer_.size();
+            buffer_.clear();
+        }
+
+    private:
+        std::uint64_t offset_;
+        std::vector<char> buffer_;
+    };
+
+    bool copyName(const std::string& name, char* field, std::size_t width) {
+        if (name.size() >= width) {
+            std::cerr << "ExternalSort: name too long for the columnar file: " << name << std::endl;
+            return false;
+        }
+        std::memset(field, 0, width);
+        std::memcpy(field, name.data(), name.size());
+        return true;
+    }
+
+    bool mergeRuns(const std::vector<std::unique_ptr<Run>>& runs, std::uint64_t rows, const std::string& outputPath,
+                   ExternalSortStats& stats) {
+        std::vector<std::unique_ptr<Cursor>> cursors;
+        std::priority_queue<Cursor*, std::vector<Cursor*>, CursorAfter> heap;
+        for (std::size_t r = 0; r < runs.size(); ++r) {
+            auto cursor = std::make_unique<Cursor>();
+            cursor->in.open(runs[r]->path, std::ios::binary);
+            cursor->run = r;
+            if (cursor->next()) heap.push(cursor.get());
+            cursors.push_back(std::move(cursor));
+        }
+
+        std::fstream out(outputPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << "ExternalSort: could not create " << outputPath << std::endl;
+            return false;
+        }
+        ColumnarHeader header;
+        header.magic = kColumnarMagic;
+        header.version = kColumnarVersion;
+        header.rowCount = rows;
+        header.priceOffset = sizeof(ColumnarHeader);
+        header.amountOffset = header.priceOffset + rows * sizeof(double);
+        header.sideOffset = header.amountOffset + rows * sizeof(double);
+        header.partitionOffset = align8(header.sideOffset + rows);
+        ColumnWriter prices(header.priceOffset), amounts(header.amountOffset), sides(header.sideOffset);
+
+        std::vector<ColumnarPartition> partitions;
+        std::vector<std::string> products;
+        std::uint64_t row = 0;
+        while (!heap.empty()) {
+            Cursor* top = heap.top();
+            heap.pop();
+            // The same bucket can come from several runs; consecutive blocks with its key extend it.
+            const bool sameProduct = !products.empty() && products.back() == top->product;
+            if (!sameProduct || partitions.back().timestamp != top->timestamp) {
+                if (!sameProduct) products.push_back(top->product);
+                ColumnarPartition p;
+                p.productId = static_cast<std::uint32_t>(products.size() - 1);
+                p.firstRow = row;
+                if (!copyName(top->timestamp, p.timestamp, sizeof p.timestamp)) return false;
+                if (!TimeKey::parseTimestamp(top->timestamp, p.timeKey)) p.timeKey = 0;
+                partitions.push_back(p);
+            }
+            for (const OrderBookEntry& e : top->block) {
+                prices.put(out, e.price);
+                amounts.put(out, e.amount);
+                sides.put(out, static_cast<std::uint8_t>(e.orderType == OrderBookType::bid ? 0 : 1));
+            }
+            partitions.back().rowCount += top->block.size();
+            row += top->block.size();
+            if (top->next()) heap.push(top);
+        }
+        prices.flush(out);
+        amounts.flush(out);
+        sides.flush(out);
+
+        header.partitionCount = partitions.size();
+        header.productCount = products.size();
+        header.productOffset = header.partitionOffset + partitions.size() * sizeof(ColumnarPartition);
+        out.seekp(static_cast<std::streamoff>(header.partitionOffset));
+        out.write(reinterpret_cast<const char*>(partitions.data()),
+                  static_cast<std::streamsize>(partitions.size() * sizeof(ColumnarPartition)));
+        char name[kColumnarNameWidth];
+        for (const std::string& product : products) {
+            if (!copyName(product, name, sizeof name)) return false;
+            out.write(name, sizeof name);
+        }
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof header);
+
+        stats.rows = row;
+        stats.partitions = partitions.size();
+        stats.products = products.size();
+        return static_cast<bool>(out);
+    }
+}
+
+// -------- sortCSV: run phase on worker threads, then the merge --------
+
+bool ExternalSort::sortCSV(const std::string& csvPath, const std::string& outputPath, const ExternalSortOptions& options,
+                           ExternalSortStats* stats) {
+    std::ifstream file(csvPath);
+    if (!file.is_open()) {
+        std::cerr << "ExternalSort: could not open " << csvPath << std::endl;
+        return false;
+    }
+    unsigned threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    const std::string runPrefix = options.tempDir + "/" +
+                                  outputPath.substr(outputPath.find_last_of("/\\") + 1) + ".run";
+
+    std::vector<std::unique_ptr<Run>> runs;
+    std::deque<std::thread> workers;  // oldest first; at most `threads` chunks in flight
+    auto startRun = [&](std::vector<std::string>&& lines) {
+        if (workers.size() == threads) {
+            workers.front().join();
+            workers.pop_front();
+        }
+        runs.push_back(std::make_unique<Run>());
+        runs.back()->path = runPrefix + std::to_string(runs.size() - 1);
+        workers.emplace_back(writeRun, std::move(lines), std::ref(*runs.back()));
+    };
+
+    std::vector<std::string> lines;
+    std::size_t chunkBytes = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        chunkBytes += line.size() + 1;
+        lines.push_back(std::move(line));
+        if (chunkBytes >= options.runBytes) {
+            startRun(std::move(lines));
+            lines = {};
+            chunkBytes = 0;
+        }
+    }
+    if (!lines.empty()) startRun(std::move(lines));
+    for (std::thread& worker : workers) worker.join();
+
+    ExternalSortStats result;
+    result.runs = runs.size();
+    std::uint64_t rows = 0;
+    bool ok = true;
+    for (const auto& run : runs) {
+        rows += run->rows;
+        if (!run->ok) {
+            std::cerr << "ExternalSort: could not write run " << run->path << std::endl;
+            ok = false;
+        }
+    }
+    ok = ok && mergeRuns(runs, rows, outputPath, result);
+    for (const auto& run : runs) std::remove(run->path.c_str());
+    if (stats) *stats = result;
+    return ok;
+}
+
+// -------- ColumnarView --------
+
+bool ColumnarView::attach(const void* data, std::size_t size) {
+    header_ = nullptr;
+    if (size < sizeof(ColumnarHeader)) return false;
+    const char* base = static_cast<const char*>(data);
+    const ColumnarHeader* h = reinterpret_cast<const ColumnarHeader*>(base);
+    if (h->magic != kColumnarMagic || h->version != kColumnarVersion) {
+        std::cerr << "ColumnarView: not a columnar order book file" << std::endl;
+        return false;
+    }
+    const std::uint64_t end = h->productOffset + h->productCount * kColumnarNameWidth;
+    if (h->sideOffset + h->rowCount > h->partitionOffset || h->productOffset < h->partitionOffset || end > size) {
+        std::cerr << "ColumnarView: truncated columnar file" << std::endl;
+        return false;
+    }
+    header_ = h;
+    prices_ = reinterpret_cast<const double*>(base + h->priceOffset);
+    amounts_ = reinterpret_cast<const double*>(base + h->amountOffset);
+    sides_ = reinterpret_cast<const std::uint8_t*>(base + h->sideOffset);
+    partitions_ = reinterpret_cast<const ColumnarPartition*>(base + h->partitionOffset);
+    products_ = base + h->productOffset;
+    return true;
+}
+
+std::string ColumnarView::product(std::size_t productId) const {
+    const char* name = products_ + productId * kColumnarNameWidth;
+    return std::string(name, std::find(name, name + kColumnarNameWidth, '\0'));
+}
+
+std::vector<OrderBookEntry> ColumnarView::entries(std::size_t i) const {
+    const ColumnarPartition& p = partitions_[i];
+    const std::string timestamp(p.timestamp, std::find(p.timestamp, p.timestamp + sizeof p.timestamp, '\0'));
+    const std::string name = product(p.productId);
+    std::vector<OrderBookEntry> out;
+    out.reserve(static_cast<std::size_t>(p.rowCount));
+    for (std::uint64_t r = p.firstRow; r < p.firstRow + p.rowCount; ++r) {
+        out.emplace_back(prices_[r], amounts_[r], timestamp, name, sides_[r] == 0 ? OrderBookType::bid : OrderBookType::ask);
+    }
+    return out;
+}
+
+// -------- Command-line tool (only when building standalone) --------
+// Build: scripts/build-ExternalSort.ps1 (defines EXTERNALSORT_STANDALONE).
+#ifdef EXTERNALSORT_STANDALONE
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: ExternalSort <input.csv> <output.obc> [runMegabytes] [threads]" << std::endl;
+        return 1;
+    }
+    ExternalSortOptions options;
+    if (argc > 3) options.runBytes = static_cast<std::size_t>(std::stoul(argv[3])) << 20;
+    if (argc > 4) options.threads = static_cast<unsigned>(std::stoul(argv[4]));
+    ExternalSortStats stats;
+    if (!ExternalSort::sortCSV(argv[1], argv[2], options, &stats)) return 1;
+    std::cout << "Sorted " << stats.rows << " orders from " << stats.runs << " runs into " << stats.partitions
+              << " partitions (" << stats.products << " products): " << argv[2] << std::endl;
+    return 0;
+}
+#endif
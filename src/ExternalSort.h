@@ -0,0 +1,114 @@
+/*
+ * ExternalSort.h — sort a CSV larger than RAM by (product, timestamp) into one columnar binary file.
+ *
+ * PURPOSE: OrderBook::load lets its std::map put the orders in order, which needs the whole file in
+ * memory. Upstream CSVs that are not time-ordered and bigger than RAM need an external sort: sort what
+ * fits, write it to disk, then merge. The result is a columnar file that readers can memory-map and use
+ * in place — no parsing, no sorting, no per-entry allocation.
+ *
+ * DESIGN (classic two-phase external merge sort):
+ *   - Run phase: the input is cut into chunks of ~runBytes of CSV text. Each chunk is parsed, stable-
+ *     sorted by (product, timestamp) and written as a run of BinaryIO partition blocks on its own
+ *     worker thread; up to `threads` chunks are in flight, so peak memory is ~threads × runBytes × 3.
+ *   - Merge phase: one k-way merge over all runs with a min-heap of run cursors keyed by
+ *     (product, timestamp, run index). Each cursor holds one partition block, so the merge moves whole
+ *     buckets, not single orders. Ties go to the earlier run, so orders keep their file order.
+ *   - Tradeoff: one merge pass is O(n log k) and reads every byte once; with thousands of runs the open
+ *     files and per-run blocks add up — raise runBytes instead of adding merge passes.
+ *
+ * OUTPUT FORMAT (native byte order, like BinaryIO — for the machine that wrote it). Every section starts
+ * on an 8-byte boundary so a mapped file can be read through the pointers ColumnarView hands out:
+ *   ColumnarHeader | price f64[rows] | amount f64[rows] | side u8[rows] (0 = bid, 1 = ask) |
+ *   ColumnarPartition[partitions] (sorted by product, then time) | product names char[32][products]
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-loading.md — External sort for huge unsorted CSVs.
+ *
+ * USE: Include "ExternalSort.h"; link ExternalSort.cpp, BinaryIO.cpp, CSVReader.cpp, OrderBookEntry.cpp,
+ * TimeKey.cpp. Standalone tool: scripts/build-ExternalSort.ps1 (defines EXTERNALSORT_STANDALONE).
+ * Build with -Isrc -pthread.
+ */
+
+#pragma once
+
+#include "OrderBookEntry.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** Fixed width of product names and timestamps in the columnar file (NUL-padded). */
+constexpr std::size_t kColumnarNameWidth = 32;
+
+/** First 72 bytes of a columnar file. Offsets are from the start of the file. */
+struct ColumnarHeader {
+    std::uint32_t magic{0};  /** 'OBC1' */
+    std::uint32_t version{0};
+    std::uint64_t rowCount{0};
+    std::uint64_t partitionCount{0};
+    std::uint64_t productCount{0};
+    std::uint64_t priceOffset{0};
+    std::uint64_t amountOffset{0};
+    std::uint64_t sideOffset{0};
+    std::uint64_t partitionOffset{0};
+    std::uint64_t productOffset{0};
+};
+
+/** One (product, timestamp) bucket: rows [firstRow, firstRow + rowCount) of the columns. */
+struct ColumnarPartition {
+    std::int64_t timeKey{0};  /** TimeKey microseconds; 0 if the timestamp did not parse */
+    std::uint64_t firstRow{0};
+    std::uint64_t rowCount{0};
+    std::uint32_t productId{0};  /** index into the product names */
+    char timestamp[kColumnarNameWidth - 4]{};  /** original CSV timestamp, NUL-padded */
+};
+
+struct ExternalSortOptions {
+    std::size_t runBytes{64u << 20};  /** CSV text per run (before parsing) */
+    unsigned threads{0};              /** run-phase workers; 0 = hardware_concurrency */
+    std::string tempDir{"."};         /** where run files go; removed after the merge */
+};
+
+struct ExternalSortStats {
+    std::uint64_t rows{0};
+    std::uint64_t partitions{0};
+    std::uint64_t products{0};
+    std::size_t runs{0};
+};
+
+namespace ExternalSort {
+    /** Sort csvPath by (product, timestamp) into the columnar file outputPath. Bad CSV lines are skipped
+        (logged, like CSVReader). Returns false (and logs) on I/O errors or names longer than the
+        fixed columns allow. */
+    bool sortCSV(const std::string& csvPath, const std::string& outputPath, const ExternalSortOptions& options,
+                 ExternalSortStats* stats = nullptr);
+}
+
+/** Read-only view over a columnar file already in memory (memory-mapped or read into a buffer).
+    Does not own or copy the bytes; they must outlive the view. */
+class ColumnarView {
+public:
+    /** Check the header and that every section lies inside [data, data + size). */
+    bool attach(const void* data, std::size_t size);
+
+    std::uint64_t rowCount() const { return header_ ? header_->rowCount : 0; }
+    std::uint64_t partitionCount() const { return header_ ? header_->partitionCount : 0; }
+    std::uint64_t productCount() const { return header_ ? header_->productCount : 0; }
+
+    const double* prices() const { return prices_; }
+    const double* amounts() const { return amounts_; }
+    const std::uint8_t* sides() const { return sides_; }
+    const ColumnarPartition& partition(std::size_t i) const { return partitions_[i]; }
+    std::string product(std::size_t productId) const;
+
+    /** Rebuild the orders of partition i (e.g. to feed OrderBook::insertOrder). */
+    std::vector<OrderBookEntry> entries(std::size_t i) const;
+
+private:
+    const ColumnarHeader* header_{nullptr};
+    const double* prices_{nullptr};
+    const double* amounts_{nullptr};
+    const std::uint8_t* sides_{nullptr};
+    const ColumnarPartition* partitions_{nullptr};
+    const char* products_{nullptr};
+};
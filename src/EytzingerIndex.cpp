@@ -0,0 +1,55 @@
+/*
+ * EytzingerIndex.cpp — build and search the BFS-ordered key array (see EytzingerIndex.h).
+ *
+ * PURPOSE: fill() lays sorted keys out in BFS order with an in-order walk; lowerBound() descends
+ * branchlessly with a prefetch four levels ahead, then recovers the answer from the path bits.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-time.md — Frozen time axis (OrderBook::freezeTimeAxis).
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc.
+ */
+
+#include "EytzingerIndex.h"
+#include "BitOps.h"
+#include <limits>
+
+// -------- Build --------
+
+EytzingerIndex::EytzingerIndex(const std::vector<std::int64_t>& sortedKeys)
+    : keys_(sortedKeys.size() + 1), rank_(sortedKeys.size() + 1) {
+    fill(sortedKeys, 0, 1);
+}
+
+// Visiting slots in-order (left subtree 2k, node k, right subtree 2k+1) meets them in sorted order.
+std::size_t EytzingerIndex::fill(const std::vector<std::int64_t>& sortedKeys, std::size_t next, std::size_t k) {
+    if (k > sortedKeys.size()) return next;
+    next = fill(sortedKeys, next, 2 * k);
+    keys_[k] = sortedKeys[next];
+    rank_[k] = static_cast<std::uint32_t>(next);
+    ++next;
+    return fill(sortedKeys, next, 2 * k + 1);
+}
+
+// -------- Search --------
+// Each step goes left (2k) if keys_[k] >= probe, else right (2k+1): no branch, just an add.
+// When k falls off the tree, its binary path records the turns; the last left turn is the answer.
+// Strip the trailing right turns (trailing 1 bits) plus that left turn to get back to it.
+
+std::size_t EytzingerIndex::lowerBound(std::int64_t probe) const {
+    const std::size_t n = size();
+    const std::int64_t* keys = keys_.data();
+    std::size_t k = 1;
+    while (k <= n) {
+        // 16k is four levels down; computed as an integer so we never form an out-of-range pointer.
+        BitOps::prefetch(reinterpret_cast<const void*>(reinterpret_cast<std::uintptr_t>(keys) + 16 * k * sizeof(std::int64_t)));
+        k = 2 * k + (keys[k] < probe ? 1 : 0);
+    }
+    k >>= BitOps::lowestSetBit(~static_cast<std::uint64_t>(k)) + 1;
+    return (k == 0) ? n : rank_[k];
+}
+
+std::size_t EytzingerIndex::upperBound(std::int64_t probe) const {
+    if (probe == std::numeric_limits<std::int64_t>::max()) return size();
+    return lowerBound(probe + 1);
+}
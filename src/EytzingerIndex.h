@@ -0,0 +1,51 @@
+/*
+ * EytzingerIndex.h — read-only sorted int64 keys in Eytzinger (BFS) order for fast lower/upper bound.
+ *
+ * PURPOSE: Once a book is loaded its timestamps do not change, and replays ask "next/previous time
+ * after t" millions of times. std::lower_bound on a sorted vector jumps around the array: the first
+ * probes land far apart, each on a different cold cache line, and each comparison is an
+ * unpredictable branch. Storing the same keys in breadth-first tree order fixes both:
+ *   - Node k's children are 2k and 2k+1, so the first levels of every search share a few cache
+ *     lines, and the 16 great-great-grandchildren of k (16k .. 16k+15) sit on adjacent lines we can
+ *     prefetch four levels ahead.
+ *   - The descent is branchless: k = 2k + (key < probe). The loop always runs ~log2(n) times.
+ *
+ * DESIGN: keys_[1..n] holds the BFS layout (slot 0 unused); rank_[k] remembers which position in
+ * the sorted order node k came from, so results are reported as sorted indices (0..n, n = none).
+ * Tradeoff: build is O(n) but the index is immutable; any insert means rebuilding (OrderBook falls
+ * back to its B+tree until freezeTimeAxis() is called again).
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-time.md — Frozen time axis after load.
+ *
+ * USE: Include "EytzingerIndex.h"; link EytzingerIndex.cpp. Build with -Isrc.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class EytzingerIndex {
+public:
+    EytzingerIndex() = default;
+
+    /** Build from keys sorted ascending (duplicates allowed). */
+    explicit EytzingerIndex(const std::vector<std::int64_t>& sortedKeys);
+
+    std::size_t size() const { return rank_.empty() ? 0 : rank_.size() - 1; }
+
+    /** Sorted index of the first key >= probe; size() if none. */
+    std::size_t lowerBound(std::int64_t probe) const;
+
+    /** Sorted index of the first key > probe; size() if none. */
+    std::size_t upperBound(std::int64_t probe) const;
+
+private:
+    /** In-order walk of the implicit tree assigns sorted keys to BFS slots. */
+    std::size_t fill(const std::vector<std::int64_t>& sortedKeys, std::size_t next, std::size_t k);
+
+    std::vector<std::int64_t> keys_;   /** BFS order, 1-based */
+    std::vector<std::uint32_t> rank_;  /** rank_[k] = sorted index of keys_[k] */
+};
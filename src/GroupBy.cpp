@@ -0,0 +1,119 @@
+/*
+ * GroupBy.cpp — per-thread hash aggregation and the final merge (see GroupBy.h).
+ *
+ * PURPOSE: add() cuts a round of buckets into one slice per worker; each worker folds its slice into
+ * its own table; finish() merges the tables and labels the rows.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-statistics.md — Group-by reports.
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc -pthread.
+ */
+
+#include "GroupBy.h"
+#include <algorithm>
+#include <thread>
+#include <tuple>
+
+namespace {
+    constexpr std::uint32_t kAllSides = 2;
+
+    /** time id in the high half; product id and side (0 bid, 1 ask, 2 both) in the low half. */
+    std::uint64_t packKey(std::uint32_t product, std::uint32_t time, std::uint32_t side) {
+        return (static_cast<std::uint64_t>(time) << 32) | (static_cast<std::uint64_t>(product) << 2) | side;
+    }
+}
+
+void GroupRow::merge(const GroupRow& other) {
+    count += other.count;
+    priceSum += other.priceSum;
+    priceMin = std::min(priceMin, other.priceMin);
+    priceMax = std::max(priceMax, other.priceMax);
+    amountSum += other.amountSum;
+    amountMin = std::min(amountMin, other.amountMin);
+    amountMax = std::max(amountMax, other.amountMax);
+    notional += other.notional;
+}
+
+GroupAggregator::GroupAggregator(bool bySide, const OrderQuery& filter, unsigned threads)
+    : bySide_(bySide), filter_(filter) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    tables_.resize(threads);
+}
+
+// -------- add: one slice per worker, balanced by order count --------
+
+void GroupAggregator::add(const std::vector<GroupInput>& inputs) {
+    if (inputs.empty() || filter_.matchesNothing()) return;
+    std::size_t total = 0;
+    for (const GroupInput& in : inputs) total += in.orders->size();
+    const std::size_t slices = std::min(tables_.size(), inputs.size());
+
+    std::vector<std::size_t> sliceStart(1, 0);
+    std::size_t rows = 0;
+    for (std::size_t i = 0; i < inputs.size() && sliceStart.size() < slices; ++i) {
+        rows += inputs[i].orders->size();
+        if (rows * slices >= total * sliceStart.size()) sliceStart.push_back(i + 1);
+    }
+    sliceStart.push_back(inputs.size());
+
+    std::vector<std::thread> workers;
+    for (std::size_t s = 1; s + 1 < sliceStart.size(); ++s) {
+        workers.emplace_back([&, s]() {
+            OrderBatch batch;
+            aggregate(inputs, sliceStart[s], sliceStart[s + 1], tables_[s], batch);
+        });
+    }
+    OrderBatch batch;
+    aggregate(inputs, sliceStart[0], sliceStart[1], tables_[0], batch);
+    for (std::thread& worker : workers) worker.join();
+}
+
+void GroupAggregator::aggregate(const std::vector<GroupInput>& inputs, std::size_t begin, std::size_t end,
+                                Table& table, OrderBatch& batch) const {
+    for (std::size_t b = begin; b < end; ++b) {
+        const std::vector<OrderBookEntry>& orders = *inputs[b].orders;
+        GroupRow bySide[2];  // one accumulator per side; [0] only when not grouped by side
+        for (std::size_t first = 0; first < orders.size(); first += OrderBatch::kRows) {
+            const OrderBookEntry* rows = orders.data() + first;
+            const std::size_t k = filter_.selectEntries(rows, std::min(OrderBatch::kRows, orders.size() - first), batch);
+            for (std::size_t j = 0; j < k; ++j) {
+                const OrderBookEntry& e = rows[batch.sel[j]];
+                bySide[bySide_ ? static_cast<int>(e.orderType) : 0].add(e.price, e.amount);
+            }
+        }
+        for (std::uint32_t side = 0; side < 2; ++side) {
+            if (bySide[side].count == 0) continue;
+            const std::uint32_t keySide = bySide_ ? side : kAllSides;
+            table[packKey(inputs[b].product, inputs[b].time, keySide)].merge(bySide[side]);
+        }
+    }
+}
+
+// -------- finish: merge the tables, label, sort --------
+
+std::vector<GroupRow> GroupAggregator::finish(const std::vector<std::string>& products,
+                                              const std::vector<std::string>& times) {
+    Table& merged = tables_[0];
+    for (std::size_t t = 1; t < tables_.size(); ++t) {
+        for (const auto& kv : tables_[t]) merged[kv.first].merge(kv.second);
+        Table().swap(tables_[t]);
+    }
+    std::vector<GroupRow> rows;
+    rows.reserve(merged.size());
+    for (const auto& kv : merged) {
+        GroupRow row = kv.second;
+        const std::uint32_t product = static_cast<std::uint32_t>(kv.first & 0xffffffffu) >> 2;
+        const std::uint32_t time = static_cast<std::uint32_t>(kv.first >> 32);
+        const std::uint32_t side = static_cast<std::uint32_t>(kv.first & 3u);
+        if (product < products.size()) row.product = products[product];
+        if (time < times.size()) row.time = times[time];
+        row.side = (side == kAllSides) ? -1 : static_cast<int>(side);
+        rows.push_back(std::move(row));
+    }
+    Table().swap(merged);
+    std::sort(rows.begin(), rows.end(), [](const GroupRow& a, const GroupRow& b) {
+        return std::tie(a.product, a.time, a.side) < std::tie(b.product, b.time, b.side);
+    });
+    return rows;
+}
@@ -0,0 +1,108 @@
+/*
+ * GroupBy.h — multi-threaded group-by over order buckets: key by product / time bucket / side, and
+ * aggregate count, sum, min, max, average and VWAP.
+ *
+ * PURPOSE: Reports ("volume per product per minute", "bid vs ask count per hour") were bespoke loops
+ * around getOrders / getAllEntriesAtTime and the compute* helpers, one core each. OrderBook::groupBy
+ * takes the grouping as data (GroupBySpec), an optional OrderQuery filter, and a thread count.
+ *
+ * DESIGN:
+ *   - Group coordinates are per bucket, not per order: the product and the time bucket of a (product,
+ *     timestamp) bucket are the same for all its orders, so OrderBook resolves them once per bucket
+ *     (product id, time id) on the calling thread. Only the side varies by row.
+ *   - Workers take contiguous slices of buckets (balanced by order count) and aggregate into their own
+ *     hash table keyed by (product id, time id, side) packed in 64 bits — no locks, no shared writes.
+ *     Inside a bucket the rows passing the filter (OrderQuery::selectEntries) go into one accumulator per
+ *     side, and each accumulator is merged into the table once per bucket.
+ *   - The per-thread tables are merged at finish(), and the rows come out sorted by product, time, side.
+ *   - Tradeoff: sums are added in a different order with a different thread count, so they can
+ *     differ in the last bits between runs with different `threads` (counts, min and max never do).
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-statistics.md — Group-by reports.
+ *
+ * USE: Include "GroupBy.h"; link GroupBy.cpp. Call OrderBook::groupBy. Build with -Isrc -pthread.
+ */
+
+#pragma once
+
+#include "OrderBookEntry.h"
+#include "OrderQuery.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/** What the groups are keyed by. With nothing set there is one group (the whole filtered book). */
+struct GroupBySpec {
+    bool byProduct{true};
+    bool bySide{false};
+    std::int64_t timeBucket{0};  /** bucket width in microseconds (e.g. 60 * TimeKey::second); 0 = not by time */
+};
+
+/** One group: its key and the aggregates of its orders. */
+struct GroupRow {
+    std::string product;  /** empty unless grouped by product */
+    std::string time;     /** bucket start ("YYYY/MM/DD HH:MM:SS.ffffff"), or the raw timestamp if it did
+                              not parse; empty unless grouped by time */
+    int side{-1};         /** static_cast<int>(OrderBookType); -1 unless grouped by side */
+
+    std::size_t count{0};
+    double priceSum{0.0};
+    double priceMin{std::numeric_limits<double>::infinity()};
+    double priceMax{-std::numeric_limits<double>::infinity()};
+    double amountSum{0.0};  /** volume */
+    double amountMin{std::numeric_limits<double>::infinity()};
+    double amountMax{-std::numeric_limits<double>::infinity()};
+    double notional{0.0};   /** sum of price * amount */
+
+    double averagePrice() const { return count ? priceSum / static_cast<double>(count) : 0.0; }
+    double averageAmount() const { return count ? amountSum / static_cast<double>(count) : 0.0; }
+    double vwap() const { return (amountSum > 0.0) ? notional / amountSum : 0.0; }
+
+    void add(double price, double amount) {
+        ++count;
+        priceSum += price;
+        priceMin = price < priceMin ? price : priceMin;
+        priceMax = price > priceMax ? price : priceMax;
+        amountSum += amount;
+        amountMin = amount < amountMin ? amount : amountMin;
+        amountMax = amount > amountMax ? amount : amountMax;
+        notional += price * amount;
+    }
+
+    void merge(const GroupRow& other);
+};
+
+/** One bucket's orders with its group coordinates (ids into the label lists given to finish()). */
+struct GroupInput {
+    const std::vector<OrderBookEntry>* orders{nullptr};
+    std::uint32_t product{0};
+    std::uint32_t time{0};
+};
+
+class GroupAggregator {
+public:
+    /** threads = 0 uses hardware_concurrency. */
+    GroupAggregator(bool bySide, const OrderQuery& filter, unsigned threads);
+
+    /** Aggregate one round of buckets in parallel; the orders must stay valid until it returns. */
+    void add(const std::vector<GroupInput>& inputs);
+
+    /** Merge the per-thread tables into rows labelled from products / times (indexed by the ids of
+        the inputs; pass empty lists for keys not grouped by), sorted by product, time, side. */
+    std::vector<GroupRow> finish(const std::vector<std::string>& products, const std::vector<std::string>& times);
+
+private:
+    using Table = std::unordered_map<std::uint64_t, GroupRow>;
+
+    /** Aggregate inputs[begin, end) into table with the thread's own batch. */
+    void aggregate(const std::vector<GroupInput>& inputs, std::size_t begin, std::size_t end, Table& table,
+                   OrderBatch& batch) const;
+
+    bool bySide_;
+    OrderQuery filter_;
+    std::vector<Table> tables_;  /** one per worker, kept across rounds */
+};
@@ -0,0 +1,145 @@
+/*
+ * Heatmap.cpp — tile-parallel binning and the CSV / binary writers (see Heatmap.h).
+ *
+ * PURPOSE: fill() cuts the inputs into column tiles, one per thread; fillTile bins each snapshot's
+ * orders into its column; finish() averages; the writers emit the matrix.
+ *
+ * DOCS (embedded references):
+ *   docs/trading-market-basics.md — Volume-at-price heatmaps.
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc -pthread.
+ */
+
+#include "Heatmap.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace {
+    constexpr std::uint32_t kHeatmapMagic = 0x3148424F;  // "OBH1" little-endian
+
+    template <typename T>
+    void put(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof value);
+    }
+
+    void appendNumber(std::string& out, double value) {
+        char text[32];
+        const std::to_chars_result r = std::to_chars(text, text + sizeof text, value);
+        out.append(text, r.ptr);
+    }
+}
+
+Heatmap::Heatmap(const std::string& product, std::vector<std::string> columnLabels,
+                 std::vector<std::int64_t> columnStarts, std::size_t priceBins, double priceLow, double priceHigh)
+    : product_(product), labels_(std::move(columnLabels)), starts_(std::move(columnStarts)),
+      priceBins_(std::max<std::size_t>(priceBins, 1)), priceLow_(priceLow), priceHigh_(priceHigh) {
+    binWidth_ = (priceHigh_ > priceLow_) ? (priceHigh_ - priceLow_) / static_cast<double>(priceBins_) : 1.0;
+    starts_.resize(labels_.size(), 0);
+    bids_.assign(labels_.size() * priceBins_, 0.0);
+    asks_.assign(labels_.size() * priceBins_, 0.0);
+    snapshots_.assign(labels_.size(), 0);
+}
+
+// -------- fill: one tile of whole columns per thread --------
+
+void Heatmap::fill(const std::vector<HeatmapInput>& inputs, unsigned threads) {
+    if (inputs.empty()) return;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t total = 0;
+    for (const HeatmapInput& in : inputs) total += in.orders->size();
+
+    // Cut after about total / threads orders, but only where the column changes.
+    std::vector<std::size_t> tileStart(1, 0);
+    std::size_t rows = 0;
+    for (std::size_t i = 0; i + 1 < inputs.size() && tileStart.size() < threads; ++i) {
+        rows += inputs[i].orders->size();
+        if (rows * threads >= total * tileStart.size() && inputs[i + 1].column != inputs[i].column) {
+            tileStart.push_back(i + 1);
+        }
+    }
+    tileStart.push_back(inputs.size());
+
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t + 1 < tileStart.size(); ++t) {
+        workers.emplace_back([&, t]() { fillTile(inputs, tileStart[t], tileStart[t + 1]); });
+    }
+    fillTile(inputs, tileStart[0], tileStart[1]);
+    for (std::thread& worker : workers) worker.join();
+}
+
+void Heatmap::fillTile(const std::vector<HeatmapInput>& inputs, std::size_t begin, std::size_t end) {
+    const double scale = 1.0 / binWidth_;
+    const double lastBin = static_cast<double>(priceBins_ - 1);
+    for (std::size_t i = begin; i < end; ++i) {
+        const std::size_t column = inputs[i].column;
+        double* bids = bids_.data() + column * priceBins_;
+        double* asks = asks_.data() + column * priceBins_;
+        ++snapshots_[column];
+        for (const OrderBookEntry& e : *inputs[i].orders) {
+            if (!(e.price >= priceLow_ && e.price <= priceHigh_)) continue;
+            const auto bin = static_cast<std::size_t>(std::min(std::floor((e.price - priceLow_) * scale), lastBin));
+            (e.orderType == OrderBookType::bid ? bids : asks)[bin] += e.amount;
+        }
+    }
+}
+
+void Heatmap::finish() {
+    for (std::size_t c = 0; c < labels_.size(); ++c) {
+        if (snapshots_[c] < 2) continue;
+        const double inv = 1.0 / static_cast<double>(snapshots_[c]);
+        for (std::size_t b = 0; b < priceBins_; ++b) {
+            bids_[c * priceBins_ + b] *= inv;
+            asks_[c * priceBins_ + b] *= inv;
+        }
+    }
+}
+
+// -------- Writers --------
+
+bool Heatmap::writeCSV(const std::string& path, bool bids, bool asks) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Could not open heatmap file: " << path << std::endl;
+        return false;
+    }
+    std::string line = "time";
+    for (std::size_t b = 0; b < priceBins_; ++b) {
+        line.push_back(',');
+        appendNumber(line, binPrice(b));
+    }
+    line.push_back('\n');
+    out.write(line.data(), static_cast<std::streamsize>(line.size()));
+    for (std::size_t c = 0; c < labels_.size(); ++c) {
+        line = labels_[c];
+        for (std::size_t b = 0; b < priceBins_; ++b) {
+            line.push_back(',');
+            appendNumber(line, (bids ? bidVolume(c, b) : 0.0) + (asks ? askVolume(c, b) : 0.0));
+        }
+        line.push_back('\n');
+        out.write(line.data(), static_cast<std::streamsize>(line.size()));
+    }
+    return static_cast<bool>(out);
+}
+
+bool Heatmap::writeBinary(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Could not open heatmap file: " << path << std::endl;
+        return false;
+    }
+    put(out, kHeatmapMagic);
+    put(out, static_cast<std::uint32_t>(priceBins_));
+    put(out, static_cast<std::uint64_t>(labels_.size()));
+    put(out, priceLow_);
+    put(out, priceHigh_);
+    out.write(reinterpret_cast<const char*>(starts_.data()), static_cast<std::streamsize>(starts_.size() * sizeof(std::int64_t)));
+    for (const std::vector<double>* grid : {&bids_, &asks_}) {
+        std::vector<float> cells(grid->begin(), grid->end());
+        out.write(reinterpret_cast<const char*>(cells.data()), static_cast<std::streamsize>(cells.size() * sizeof(float)));
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,108 @@
+/*
+ * Heatmap.h — volume-at-price profile of one product over time: a price × time grid of resting bid and
+ * ask volume, filled in parallel tiles and written as a CSV or compact binary matrix.
+ *
+ * PURPOSE: The research UI renders full-day liquidity heatmaps. Producing one by calling getOrders per
+ * timestamp and binning by hand took minutes: a bucket copy per call and a single thread. The book
+ * already holds each product's buckets in time order, so the grid can be filled straight from them.
+ *
+ * DESIGN:
+ *   - Grid: priceBins equal-width rows over [priceLow, priceHigh] (the product's low..high in the window
+ *     when not given) × time columns (one per timeBucket microseconds, or one per timestamp when
+ *     timeBucket is 0). Cells are stored column-major — column c is priceBins adjacent values — so one
+ *     column is one contiguous tile of memory.
+ *   - A bucket is one snapshot of the product's book. Cell value = resting volume in that price bin,
+ *     averaged over the column's snapshots (summing snapshots would count the same resting order once
+ *     per timestamp). Bid and ask volume are kept as separate grids.
+ *   - fill(): the caller lists buckets with their column; the list is cut at column boundaries into one
+ *     tile per thread, so every thread writes its own columns and no cell is shared.
+ *   - Binary format (native byte order, like BinaryIO): u32 magic 'OBH1' | u32 priceBins |
+ *     u64 columns | f64 priceLow | f64 priceHigh | columns x i64 column start (TimeKey micros; 0 if
+ *     unparsed) | columns x priceBins f32 bid volume | the same for asks.
+ *   - Tradeoff: the book holds orders, not trades, so the grid shows resting liquidity only; orders
+ *     outside [priceLow, priceHigh] are left out.
+ *
+ * DOCS (embedded references):
+ *   docs/trading-market-basics.md — Volume-at-price heatmaps.
+ *
+ * USE: Include "Heatmap.h"; link Heatmap.cpp. Call OrderBook::buildHeatmap, then writeCSV / writeBinary.
+ * Build with -Isrc -pthread.
+ */
+
+#pragma once
+
+#include "OrderBookEntry.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** What OrderBook::buildHeatmap bins. Empty from / to mean the product's whole history. */
+struct HeatmapSpec {
+    std::string product;
+    std::string from;
+    std::string to;
+    std::size_t priceBins{100};
+    double priceLow{0.0};         /** price range; priceHigh <= priceLow = the product's low..high in the window */
+    double priceHigh{0.0};
+    std::int64_t timeBucket{0};   /** column width in microseconds (e.g. 60 * TimeKey::second); 0 = per timestamp */
+};
+
+/** One snapshot to bin: a bucket's orders and the column it falls in. */
+struct HeatmapInput {
+    const std::vector<OrderBookEntry>* orders{nullptr};
+    std::size_t column{0};
+};
+
+class Heatmap {
+public:
+    Heatmap() = default;
+
+    /** Empty grid of columnLabels.size() columns × priceBins rows over [priceLow, priceHigh]. */
+    Heatmap(const std::string& product, std::vector<std::string> columnLabels, std::vector<std::int64_t> columnStarts,
+            std::size_t priceBins, double priceLow, double priceHigh);
+
+    /** Bin inputs (sorted by column) with up to `threads` workers, one tile of whole columns each
+        (0 = hardware_concurrency). May be called several times (e.g. once per paging round). */
+    void fill(const std::vector<HeatmapInput>& inputs, unsigned threads);
+
+    /** Turn the sums into per-snapshot averages; call once after the last fill. */
+    void finish();
+
+    const std::string& getProduct() const { return product_; }
+    std::size_t columnCount() const { return labels_.size(); }
+    std::size_t priceBins() const { return priceBins_; }
+    double priceLow() const { return priceLow_; }
+    double priceHigh() const { return priceHigh_; }
+    /** Lower price edge of row b. */
+    double binPrice(std::size_t bin) const { return priceLow_ + static_cast<double>(bin) * binWidth_; }
+    const std::string& columnLabel(std::size_t column) const { return labels_[column]; }
+
+    /** Average resting volume at (column, bin). */
+    double bidVolume(std::size_t column, std::size_t bin) const { return bids_[column * priceBins_ + bin]; }
+    double askVolume(std::size_t column, std::size_t bin) const { return asks_[column * priceBins_ + bin]; }
+    /** Snapshots (timestamps) that fell in column. */
+    std::size_t snapshots(std::size_t column) const { return snapshots_[column]; }
+
+    /** One line per column: label, then priceBins values; header line of bin lower prices. Values are
+        bid, ask or bid + ask volume. Returns false (logged) if path cannot be written. */
+    bool writeCSV(const std::string& path, bool bids = true, bool asks = true) const;
+
+    /** The binary matrix described above. Returns false (logged) if path cannot be written. */
+    bool writeBinary(const std::string& path) const;
+
+private:
+    /** Bin inputs[begin, end): all of one tile's columns. */
+    void fillTile(const std::vector<HeatmapInput>& inputs, std::size_t begin, std::size_t end);
+
+    std::string product_;
+    std::vector<std::string> labels_;
+    std::vector<std::int64_t> starts_;
+    std::size_t priceBins_{0};
+    double priceLow_{0.0};
+    double priceHigh_{0.0};
+    double binWidth_{0.0};
+    std::vector<double> bids_;  /** column-major: [column * priceBins_ + bin] */
+    std::vector<double> asks_;
+    std::vector<std::size_t> snapshots_;
+};
@@ -0,0 +1,67 @@
+/*
+ * LoserTree.h — tournament tree of losers for k-way merging of sorted streams.
+ *
+ * PURPOSE: Merging k sorted sources means asking "which head is smallest?" once per output element.
+ * A binary heap answers with a sift-down: up to 2·log2(k) comparisons, each against a sibling that may
+ * itself have to move. A loser tree stores at every inner node the loser of the match played there;
+ * the overall winner sits in slot 0. After the winner's source advances, only its path to the root is
+ * replayed — exactly ceil(log2(k)) comparisons, one per level, with no data moves besides the node.
+ *
+ * DESIGN:
+ *   - Sources are identified by index 0..k-1; leaf of source i is node k + i, node n's parent is n / 2.
+ *   - The tree does not see the elements: beats(a, b) says whether source a's current head must come
+ *     out before source b's. An exhausted source must never beat a live one; break ties by index so
+ *     the merge is stable.
+ *   - Tradeoff: the comparator is called with indices, so the caller keeps the heads (and can move
+ *     whole records without the tree copying them).
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-loading.md — Multi-venue loading (ConsolidatedBook).
+ *
+ * USE: Header-only template. Include "LoserTree.h". Build with -Isrc.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+template <typename Beats>
+class LoserTree {
+public:
+    /** Build the tournament over k sources whose heads are already in place. O(k). */
+    LoserTree(std::size_t k, Beats beats) : k_(k), beats_(std::move(beats)), tree_(k > 0 ? k : 1, 0) {
+        if (k_ > 0) tree_[0] = play(1);
+    }
+
+    /** Source whose head comes out next. */
+    std::size_t winner() const { return tree_[0]; }
+
+    /** The winner's head changed (advanced or ran out): replay its path to the root. */
+    void replay() {
+        std::size_t contender = tree_[0];
+        for (std::size_t node = (contender + k_) / 2; node >= 1; node /= 2) {
+            if (beats_(tree_[node], contender)) std::swap(tree_[node], contender);
+        }
+        tree_[0] = contender;
+    }
+
+private:
+    /** Winner of the subtree at node; records the loser of each inner match on the way. */
+    std::size_t play(std::size_t node) {
+        if (node >= k_) return node - k_;
+        const std::size_t left = play(2 * node);
+        const std::size_t right = play(2 * node + 1);
+        if (beats_(right, left)) {
+            tree_[node] = left;
+            return right;
+        }
+        tree_[node] = right;
+        return left;
+    }
+
+    std::size_t k_;
+    Beats beats_;
+    std::vector<std::size_t> tree_;  /** tree_[0] = winner, tree_[1..k-1] = losers of inner matches */
+};
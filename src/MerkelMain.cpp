@@ -9,22 +9,25 @@
  *   docs/merkel-main.md     — MerkelMain class, init/run, time-stepping.
  *   docs/orderbook-time.md  — Timestamps, getNextTime/getPreviousTime, currentTimestamp_.
  *   docs/orderbook-statistics.md — Mean, spread, change vs prev; computeAveragePrice, etc.
+ *   docs/orderbook-statistics.md — Streaming volatility: Continue feeds volatility_, prints spikes.
  *   docs/trading-market-basics.md — Bid, ask, best bid/ask, spread.
  *   docs/organizing-code.md  — Why orderBook_ is private; exposure via getters.
  *
  * PROJECT LAYOUT: Source in src/. Build from repo root: .\run.ps1 or scripts/build-MerkelMain.ps1 or
- *   g++ -std=c++17 -Isrc -o build/MerkelMain.exe src/MerkelMain.cpp src/OrderBookEntry.cpp src/OrderBook.cpp src/CSVReader.cpp
+ *   g++ -std=c++17 -pthread -Isrc -o build/MerkelMain.exe src/MerkelMain.cpp src/OrderBookEntry.cpp src/OrderBook.cpp src/CSVReader.cpp src/StopOrderIndex.cpp src/PriceLevelIndex.cpp src/TimeKey.cpp src/EytzingerIndex.cpp src/RangeStats.cpp src/BookHistory.cpp src/SummaryTable.cpp src/ReloadableOrderBook.cpp src/BinaryIO.cpp src/ConsolidatedBook.cpp src/ExportWriter.cpp src/CompressedColumns.cpp src/OrderQuery.cpp src/GroupBy.cpp src/AsOfJoin.cpp src/VolatilityMonitor.cpp src/CorrelationMatrix.cpp src/Heatmap.cpp src/TimePyramid.cpp src/ExecutionSimulator.cpp src/TopOrders.cpp
  *
- * EMBEDDING INIT: init() calls orderBook_.load(orderBookPath_) so the order book is loaded once.
+ * EMBEDDING INIT: init() starts orderBook_.current()->loadAsync(orderBookPath_) so the order book is loaded once;
+ * option 7 (Reload) rebuilds it in the background and swaps it in (ReloadableOrderBook).
  *
- * LIMITING EXPOSURE: orderBook_ is private. printMarketStats() uses orderBook_.getAllEntries(),
- * getAllEntriesAtTime(), and OrderBookEntry helpers (computeAveragePrice, computePriceChange, etc.).
+ * LIMITING EXPOSURE: orderBook_ is private. printMarketStats() reads orderBook_'s precomputed summary
+ * rows (getTimeSummary, getSummary, getEntryCount) rather than re-aggregating raw orders.
  *
- * FLOW: main() → MerkelMain() → init() once → run() (menu loop until user picks Continue).
+ * FLOW: main() → MerkelMain() → init() once → run() (menu loop until user picks Exit; Continue steps time).
  */
 
 #include "MerkelMain.h"
 #include <iostream>
+#include <memory>
 #include <string>
 #include <limits>
 #include <sstream>
@@ -48,23 +51,37 @@ namespace Log {
 // -------- Constructor --------
 MerkelMain::MerkelMain() {}
 
-// -------- init(): one-time setup; load order book --------
+// -------- init(): one-time setup; start loading the order book --------
+// The load runs on a background thread (OrderBook::loadAsync) so the menu is usable at once; stats and
+// stepping see every timestamp committed so far. See docs/orderbook-loading.md.
 void MerkelMain::init() {
     Log::section("STARTUP");
     orderBookPath_ = "data/order_book_example.csv";
-    orderBook_.load(orderBookPath_);
-    size_t count = orderBook_.getAllEntries().size();
-    if (count > 0) {
-        currentTimestamp_ = orderBook_.getEarliestTime();
-        Log::info("Order book loaded.");
-        Log::kv("orders", count);
-        Log::kv("path", orderBookPath_);
-        Log::kv("currentTime", currentTimestamp_);
-    } else {
-        currentTimestamp_.clear();
-        Log::warn("No order book loaded; stats will show placeholder.");
-        Log::kv("path", orderBookPath_);
+    orderBook_.current()->loadAsync(orderBookPath_);
+    currentTimestamp_.clear();
+    Log::info("Loading order book in background; menu is ready now.");
+    Log::kv("path", orderBookPath_);
+}
+
+/** Until the first timestamp has loaded there is no current time; pick it up as soon as it exists.
+    After a reload swapped in a new book, keep the current time only if the new book still has it. */
+void MerkelMain::syncCurrentTime(const OrderBook& book, std::uint64_t version) {
+    if (bookVersion_ != version) {
+        bookVersion_ = version;
+        if (!currentTimestamp_.empty() && book.getTimesBetween(currentTimestamp_, currentTimestamp_).empty()) {
+            currentTimestamp_.clear();
+            volatility_.reset();  // the replay restarts from the earliest time of the new book
+        }
     }
+    if (currentTimestamp_.empty()) currentTimestamp_ = book.getEarliestTime();
+}
+
+/** One-line load status while loadAsync is still running (nothing once it has finished). */
+void MerkelMain::printLoadProgress(const OrderBook& book) {
+    LoadProgress progress = book.getLoadProgress();
+    if (!progress.loading) return;
+    std::cout << "  Loading: " << Format::price(progress.percent(), 1) << "% (" << progress.entries
+              << " orders so far)" << std::endl;
 }
 
 // -------- run(): main menu loop --------
@@ -76,7 +93,7 @@ void MerkelMain::run() {
         validateUserOption(userOption);
         MenuOption choice = static_cast<MenuOption>(userOption);
         handleUserOption(choice);
-        if (choice == MenuOption::Continue) {
+        if (choice == MenuOption::Exit) {
             std::cout << "Goodbye." << std::endl;
             break;
         }
@@ -94,13 +111,15 @@ void MerkelMain::printMenu() {
     std::cout << "4. Enter bid" << std::endl;
     std::cout << "5. Print wallet" << std::endl;
     std::cout << "6. Continue (next time step)" << std::endl;
+    std::cout << "7. Reload order book" << std::endl;
+    std::cout << "8. Exit" << std::endl;
     std::cout << SEP << std::endl;
 }
 
-// -------- getUserOption(): read 1–6 from user --------
+// -------- getUserOption(): read 1–8 from user --------
 int MerkelMain::getUserOption() {
     const char SEP[] = "================================================";
-    std::cout << "Enter your choice: 1-6: " << std::endl;
+    std::cout << "Enter your choice: 1-8: " << std::endl;
     std::cout << SEP << std::endl;
     int userOption = 0;
     std::cin >> userOption;
@@ -113,11 +132,11 @@ int MerkelMain::getUserOption() {
     return userOption;
 }
 
-// -------- validateUserOption(): re-prompt until 1–6 --------
+// -------- validateUserOption(): re-prompt until 1–8 --------
 void MerkelMain::validateUserOption(int& userOption) {
-    while (userOption < static_cast<int>(MenuOption::Help) || userOption > static_cast<int>(MenuOption::Continue)) {
-        std::cout << "Invalid choice. Choice 1-6 only." << std::endl;
-        std::cout << "Enter your choice: 1-6: ";
+    while (userOption < static_cast<int>(MenuOption::Help) || userOption > static_cast<int>(MenuOption::Exit)) {
+        std::cout << "Invalid choice. Choice 1-8 only." << std::endl;
+        std::cout << "Enter your choice: 1-8: ";
         std::cin >> userOption;
         if (std::cin.fail()) {
             std::cin.clear();
@@ -166,6 +185,11 @@ void MerkelMain::handleUserOption(MenuOption choice) {
         case MenuOption::Continue:
             continueToNextTimeStep();
             break;
+        case MenuOption::Reload:
+            reloadOrderBook();
+            break;
+        case MenuOption::Exit:
+            break;
     }
 }
 
@@ -175,41 +199,53 @@ void MerkelMain::printHelp() {
     std::cout << "Help = your aim is to make $$. Analyze..." << std::endl;
 }
 
-/** Stats: current-time window (mean, low, high, spread, change vs prev, best bid/ask). See docs/orderbook-statistics.md, docs/trading-market-basics.md. */
+/** Stats: current-time window (mean, low, high, spread, change vs prev, best bid/ask). Reads the precomputed
+    summary rows (OrderBook::getTimeSummary / getSummary) instead of copying and rescanning orders.
+    See docs/orderbook-statistics.md, docs/trading-market-basics.md. */
 void MerkelMain::printMarketStats() {
-    std::vector<OrderBookEntry> all = orderBook_.getAllEntries();
-    if (all.empty()) {
-        std::cout << "Market looks good. Sell high, buy low. (No order book loaded.)" << std::endl;
+    std::uint64_t version = 0;
+    std::shared_ptr<OrderBook> book = orderBook_.current(version);  // one version for the whole report
+    syncCurrentTime(*book, version);
+    std::size_t total = book->getEntryCount();
+    if (total == 0) {
+        if (book->isLoading()) {
+            std::cout << "Order book is still loading; no orders yet." << std::endl;
+            printLoadProgress(*book);
+        } else {
+            std::cout << "Market looks good. Sell high, buy low. (No order book loaded.)" << std::endl;
+        }
         return;
     }
-    std::vector<OrderBookEntry> atCurrent = orderBook_.getAllEntriesAtTime(currentTimestamp_);
-    std::cout << "Order book (total " << all.size() << " entries, " << orderBook_.getKnownProducts().size() << " products)" << std::endl;
+    SummaryRow current = book->getTimeSummary(currentTimestamp_);
+    std::vector<std::string> products = book->getKnownProducts();
+    std::cout << "Order book (total " << total << " entries, " << products.size() << " products)" << std::endl;
+    printLoadProgress(*book);
     std::cout << "  Current time:  " << currentTimestamp_ << std::endl;
-    std::cout << "  Orders at current time: " << atCurrent.size() << std::endl;
-    if (!atCurrent.empty()) {
+    std::cout << "  Orders at current time: " << current.count << std::endl;
+    if (current.count > 0) {
         std::cout << "  --- Stats for current time window ---" << std::endl;
-        std::cout << "  Mean price:    " << Format::price(computeAveragePrice(atCurrent)) << std::endl;
-        std::cout << "  Low price:     " << Format::price(computeLowPrice(atCurrent)) << std::endl;
-        std::cout << "  High price:    " << Format::price(computeHighPrice(atCurrent)) << std::endl;
-        std::cout << "  Price spread:  " << Format::price(computePriceSpread(atCurrent)) << std::endl;
-        std::string prevTime = orderBook_.getPreviousTime(currentTimestamp_);
+        std::cout << "  Mean price:    " << Format::price(current.averagePrice()) << std::endl;
+        std::cout << "  Low price:     " << Format::price(current.minPrice) << std::endl;
+        std::cout << "  High price:    " << Format::price(current.maxPrice) << std::endl;
+        std::cout << "  Price spread:  " << Format::price(current.priceSpread()) << std::endl;
+        std::string prevTime = book->getPreviousTime(currentTimestamp_);
         if (!prevTime.empty()) {
-            std::vector<OrderBookEntry> atPrevious = orderBook_.getAllEntriesAtTime(prevTime);
-            if (!atPrevious.empty()) {
-                double change = computePriceChange(atCurrent, atPrevious);
-                double pct = computePercentChange(atCurrent, atPrevious);
+            SummaryRow previous = book->getTimeSummary(prevTime);
+            if (previous.count > 0) {
+                // Same arithmetic as computePriceChange / computePercentChange on the two windows.
+                double meanPrev = previous.averagePrice();
+                double change = current.averagePrice() - meanPrev;
+                double pct = (meanPrev == 0.0) ? 0.0 : change / meanPrev * 100.0;
                 std::cout << "  Change vs prev: " << Format::price(change) << " (" << Format::price(pct) << "%)" << std::endl;
             }
         } else {
             std::cout << "  Change vs prev: (no previous time)" << std::endl;
         }
-        std::vector<std::string> products = orderBook_.getKnownProducts();
         if (!products.empty()) {
             const std::string& p = products[0];
-            double bid = orderBook_.getBestBid(p, currentTimestamp_);
-            double ask = orderBook_.getBestAsk(p, currentTimestamp_);
-            std::cout << "  Best bid (" << p << "): " << Format::price(bid) << std::endl;
-            std::cout << "  Best ask (" << p << "): " << Format::price(ask) << std::endl;
+            SummaryRow row = book->getSummary(p, currentTimestamp_);
+            std::cout << "  Best bid (" << p << "): " << Format::price(row.bestBid) << std::endl;
+            std::cout << "  Best ask (" << p << "): " << Format::price(row.bestAsk) << std::endl;
         }
     }
 }
@@ -237,12 +273,39 @@ void MerkelMain::printWallet() {
 }
 
 void MerkelMain::continueToNextTimeStep() {
-    std::string next = orderBook_.getNextTime(currentTimestamp_);
-    if (next.empty()) {
+    std::uint64_t version = 0;
+    std::shared_ptr<OrderBook> book = orderBook_.current(version);
+    syncCurrentTime(*book, version);
+    std::string next = currentTimestamp_.empty() ? "" : book->getNextTime(currentTimestamp_);
+    if (next.empty() && book->isLoading()) {
+        std::cout << "Next time step has not loaded yet." << std::endl;
+        printLoadProgress(*book);
+    } else if (next.empty()) {
         std::cout << "End of order book (no next time step)." << std::endl;
     } else {
+        // Both steps go to the monitor; a timestamp it has already seen is skipped, so each is fed once.
+        std::vector<VolatilityEvent> events;
+        volatility_.onTimeStep(book->getSummariesAtTime(currentTimestamp_), events);
         currentTimestamp_ = next;
         std::cout << "Now at time: " << currentTimestamp_ << std::endl;
+        volatility_.onTimeStep(book->getSummariesAtTime(currentTimestamp_), events);
+        for (const VolatilityEvent& e : events) {
+            if (e.kind != VolatilityEventKind::spike) continue;
+            std::cout << "Volatility spike: " << e.product << " mid " << e.mid << " (return " << e.logReturn * 100.0
+                      << "%, z = " << e.zScore << ", realized vol " << e.realizedVol * 100.0 << "%)" << std::endl;
+        }
+    }
+}
+
+/** Reload: rebuild the book from orderBookPath_ on a worker thread; the menu keeps using the current
+    book until the new one is complete, then switches atomically. See docs/orderbook-loading.md. */
+void MerkelMain::reloadOrderBook() {
+    if (orderBook_.current()->isLoading()) {
+        std::cout << "Order book is still loading; try Reload again when it has finished." << std::endl;
+    } else if (orderBook_.reloadAsync(orderBookPath_)) {
+        std::cout << "Reloading " << orderBookPath_ << " in background; stats use the current book until it is ready." << std::endl;
+    } else {
+        std::cout << "A reload is already running." << std::endl;
     }
 }
 
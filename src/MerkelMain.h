@@ -23,15 +23,20 @@
 #include <vector>
 #include "OrderBook.h"
 #include "OrderBookEntry.h"
+#include "ReloadableOrderBook.h"
+#include "VolatilityMonitor.h"
+#include <cstdint>
 
-/** Menu options (1–6). Cast getUserOption() result to MenuOption for handleUserOption(). See docs/merkel-main.md. */
+/** Menu options (1–8). Cast getUserOption() result to MenuOption for handleUserOption(). See docs/merkel-main.md. */
 enum class MenuOption {
     Help     = 1,  /** Print help text */
     Stats    = 2,  /** Print exchange stats (order book, current time, mean/spread/change, best bid/ask) */
     Ask      = 3,  /** Enter an ask (sell order) */
     Bid      = 4,  /** Enter a bid (buy order) */
     Wallet   = 5,  /** Print wallet (placeholder) */
-    Continue = 6   /** Advance to next time step; exit loop when chosen */
+    Continue = 6,  /** Advance to next time step; the menu stays open */
+    Reload   = 7,  /** Rebuild the order book from its file in the background and swap it in */
+    Exit     = 8   /** Leave the menu loop */
 };
 
 // -------- MerkelMain: exchange application --------
@@ -42,7 +47,7 @@ public:
     /** One-time setup (e.g. load config, order book). Called once before run(). */
     void init();
 
-    /** Main loop: print menu, get option, validate, handle, exit on Continue. */
+    /** Main loop: print menu, get option, validate, handle, exit on Exit. */
     void run();
 
     // -------- Menu actions (one per option) --------
@@ -52,14 +57,15 @@ public:
     void enterBid();
     void printWallet();
     void continueToNextTimeStep();
+    void reloadOrderBook();
 
     /** Dispatch: call the action for the given menu choice. */
     void handleUserOption(MenuOption choice);
 
-    /** Read user choice 1–6; returns int. Caller may then cast to MenuOption. */
+    /** Read user choice 1–8; returns int. Caller may then cast to MenuOption. */
     int getUserOption();
 
-    /** Re-prompt until choice is 1–6. Pass by reference so we can update the value. */
+    /** Re-prompt until choice is 1–8. Pass by reference so we can update the value. */
     void validateUserOption(int& userOption);
 
     /** Read amount and price from stdin (shared by enterAsk and enterBid). */
@@ -67,11 +73,21 @@ public:
 
 private:
     void printMenu();
+    /** Set currentTimestamp_ to the earliest loaded time if it is still empty (background load) or no
+        longer in book (after a reload). version: the swap count book was published with. */
+    void syncCurrentTime(const OrderBook& book, std::uint64_t version);
+    /** Print "Loading: x% (n orders so far)" while book's background load runs. */
+    void printLoadProgress(const OrderBook& book);
 
     std::string orderBookPath_;
-    OrderBook orderBook_;
+    /** Live book behind an atomically swapped shared_ptr; take orderBook_.current() once per action. */
+    ReloadableOrderBook orderBook_;
+    /** Book version that currentTimestamp_ was last checked against (from orderBook_.current(version)). */
+    std::uint64_t bookVersion_{0};
     /** Current time step (earliest after init; advances on Continue). */
     std::string currentTimestamp_;
+    /** Per-product volatility estimates, fed each time step on Continue; spikes are printed. */
+    VolatilityMonitor volatility_;
 };
 
 #endif /* MERKELMAIN_H */
@@ -2,39 +2,210 @@
  * OrderBook.cpp — implementation of OrderBook: load CSV, filter by product/timestamp.
  *
  * PURPOSE: Constructor loads entries via CSVReader::readCSV and groups by (product, timestamp).
- * getOrders / matchOrders look up that map; getBestBid / getBestAsk return highest bid and lowest ask.
+ * getOrders / matchOrders look up that map; getBestBid / getBestAsk return highest bid and lowest ask
+ * (from the bitmap ladder for products registered with setTickGrid, otherwise from the B+tree depth levels).
  *
  * DOCS (embedded references):
  *   docs/orderbook-matching.md — getOrders(type, product, timestamp) for matching.
  *   docs/trading-market-basics.md — Best bid = highest bid; best ask = lowest ask.
- *   docs/orderbook-time.md — Time helpers delegate to OrderBookEntry free functions.
+ *   docs/orderbook-time.md — Time helpers read the B+tree time axis (timeAxis_).
+ *   docs/orderbook-matching.md — Stop orders: parked in stops_, inserted when triggered.
+ *   docs/orderbook-loading.md — loadAsync: loader thread commits one timestamp per lock.
  *
  * BUILD: Include in targets that use OrderBook (e.g. MerkelMain). Compile with -Isrc.
  */
 
 #include "OrderBook.h"
+#include "BinaryIO.h"
+#include "ExportWriter.h"
+#include "TimeKey.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
 #include <set>
 
-// -------- Constructor --------
+namespace {
+    /** Map a price to an int64 with the same ordering (IEEE-754 bit trick), so any double can key
+        a BPlusTree exactly — no tick size needed. Negative prices flip their magnitude bits. */
+    std::int64_t priceKey(double price) {
+        if (price == 0.0) price = 0.0;  // fold -0.0 into +0.0
+        std::int64_t bits;
+        std::memcpy(&bits, &price, sizeof bits);
+        return (bits >= 0) ? bits : bits ^ INT64_MAX;
+    }
+
+    double priceFromKey(std::int64_t key) {
+        const std::int64_t bits = (key >= 0) ? key : key ^ INT64_MAX;
+        double price;
+        std::memcpy(&price, &bits, sizeof price);
+        return price;
+    }
+}
+
+// -------- Constructor / destructor --------
 OrderBook::OrderBook(const std::string& filename) {
     load(filename);
 }
 
+OrderBook::~OrderBook() {
+    stopLoader();
+}
+
 // -------- load --------
-// Clear map and (re)load from CSV; group by (product, timestamp).
+// Parse and index into a staging book without holding our lock, then swap the indexes in: readers see
+// the old book until the new one is complete, never an empty or half-loaded one. The lock is held only
+// for the swap and the ticker republish.
 
 void OrderBook::load(const std::string& filename) {
-    ordersByProductTime_.clear();
+    stopLoader();
+    OrderBook staging;
+    {
+        Lock lock(mutex_);
+        staging.tickGrids_ = tickGrids_;  // so the staging book builds the same ladders
+    }
+    staging.buildFrom(filename);
+    Lock lock(mutex_);
+    swapIndexes(staging);
+    resetPaging();
+    publishAllTops();
+    if (history_) recordHistory();
+    enforceRetention();
+}
+
+void OrderBook::buildFrom(const std::string& filename) {
+    resetBook();
     std::vector<OrderBookEntry> entries = CSVReader::readCSV(filename);
     for (const OrderBookEntry& e : entries) {
         ordersByProductTime_[{e.product, e.timestamp}].push_back(e);
+        indexOrder(e);
+        indexLevel(e);
     }
+    entryCount_ = entries.size();
+    for (const auto& kv : ordersByProductTime_) summaries_.append(kv.first.first, kv.first.second, kv.second);
+    summaries_.finish();
+    finishLoad();
+}
+
+void OrderBook::swapIndexes(OrderBook& other) {
+    std::swap(ordersByProductTime_, other.ordersByProductTime_);
+    std::swap(depthByProductTime_, other.depthByProductTime_);
+    std::swap(levelsByProductTime_, other.levelsByProductTime_);
+    std::swap(timeAxis_, other.timeAxis_);
+    std::swap(unkeyedTimes_, other.unkeyedTimes_);
+    std::swap(frozenTimeIndex_, other.frozenTimeIndex_);
+    std::swap(frozenTimes_, other.frozenTimes_);
+    std::swap(timeAxisFrozen_, other.timeAxisFrozen_);
+    std::swap(rangeStats_, other.rangeStats_);
+    std::swap(pyramids_, other.pyramids_);
+    std::swap(rangeStatsCurrent_, other.rangeStatsCurrent_);
+    std::swap(summaries_, other.summaries_);
+    entryCount_ = other.entryCount_.exchange(entryCount_.load());
+}
+
+void OrderBook::resetBook() {
+    ordersByProductTime_.clear();
+    levelsByProductTime_.clear();
+    depthByProductTime_.clear();
+    timeAxis_.clear();
+    unkeyedTimes_ = 0;
+    timeAxisFrozen_ = false;
+    summaries_.clear();
+    rangeStats_.clear();
+    pyramids_.clear();
+    rangeStatsCurrent_ = false;
+    entryCount_ = 0;
+    if (history_) history_->clear();
+    resetPaging();
+}
+
+void OrderBook::finishLoad() {
+    freezeTimeAxis();
+    buildRangeStats();
+    publishAllTops();
+}
+
+// -------- Background load (see docs/orderbook-loading.md) --------
+// The loader parses without the lock and only takes it to commit a batch, so the menu thread waits at
+// most one batch. A batch ends when the timestamp changes: a timestamp becomes visible all at once, and
+// (for a time-sorted file) every visible timestamp is complete. kMaxBatch bounds the wait if a single
+// timestamp is huge.
+
+void OrderBook::loadAsync(const std::string& filename) {
+    stopLoader();
+    {
+        Lock lock(mutex_);
+        resetBook();
+        publishAllTops();  // readers see the empty book, not the previous file
+    }
+    bytesRead_ = 0;
+    totalBytes_ = 0;
+    loading_ = true;
+    loader_ = std::thread(&OrderBook::loadWorker, this, filename);
+}
+
+void OrderBook::loadWorker(const std::string& filename) {
+    constexpr std::size_t kMaxBatch = 4096;
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Could not open file: " << filename << std::endl;
+        loading_ = false;
+        return;
+    }
+    file.seekg(0, std::ios::end);
+    totalBytes_ = static_cast<std::uint64_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+
+    std::vector<OrderBookEntry> batch;
+    auto commit = [this, &batch]() {
+        Lock lock(mutex_);
+        for (const OrderBookEntry& e : batch) insertOrder(e);
+        batch.clear();
+    };
+    std::string line;
+    OrderBookEntry entry;
+    std::uint64_t bytes = 0;
+    while (!stopLoading_ && std::getline(file, line)) {
+        bytes += line.size() + 1;  // + newline; progress only, so CRLF rounding does not matter
+        bytesRead_.store(bytes, std::memory_order_relaxed);
+        if (!CSVReader::parseLine(line, entry)) continue;
+        if (!batch.empty() && (entry.timestamp != batch.back().timestamp || batch.size() >= kMaxBatch)) commit();
+        batch.push_back(entry);
+    }
+    commit();
+    {
+        Lock lock(mutex_);
+        finishLoad();
+    }
+    if (!stopLoading_) bytesRead_ = totalBytes_.load();
+    loading_ = false;
+}
+
+LoadProgress OrderBook::getLoadProgress() const {
+    LoadProgress progress;
+    progress.bytesRead = bytesRead_.load(std::memory_order_relaxed);
+    progress.totalBytes = totalBytes_.load(std::memory_order_relaxed);
+    progress.entries = entryCount_.load();
+    progress.loading = loading_.load();
+    return progress;
+}
+
+void OrderBook::waitForLoad() {
+    if (loader_.joinable()) loader_.join();
+}
+
+void OrderBook::stopLoader() {
+    stopLoading_ = true;
+    waitForLoad();
+    stopLoading_ = false;
 }
 
 // -------- Known products --------
 // Unique product names from map keys (one per product).
 
 std::vector<std::string> OrderBook::getKnownProducts() const {
+    Lock lock(mutex_);
     std::set<std::string> products;
     for (const auto& kv : ordersByProductTime_) {
         products.insert(kv.first.first);  // product from (product, timestamp)
@@ -46,10 +217,11 @@ std::vector<std::string> OrderBook::getKnownProducts() const {
 // Look up (product, timestamp) in map; filter that bucket by bid/ask.
 
 std::vector<OrderBookEntry> OrderBook::getOrders(OrderBookType type, const std::string& product, const std::string& timestamp) const {
+    Lock lock(mutex_);
     auto it = ordersByProductTime_.find({product, timestamp});
     if (it == ordersByProductTime_.end()) return {};
     std::vector<OrderBookEntry> filtered;
-    for (const OrderBookEntry& e : it->second) {
+    for (const OrderBookEntry& e : pageIn(*it)) {
         if (e.orderType == type) filtered.push_back(e);
     }
     return filtered;
@@ -58,60 +230,558 @@ std::vector<OrderBookEntry> OrderBook::getOrders(OrderBookType type, const std::
 // -------- Insert --------
 
 void OrderBook::insertOrder(const OrderBookEntry& order) {
-    ordersByProductTime_[{order.product, order.timestamp}].push_back(order);
+    Lock lock(mutex_);
+    const auto emplaced = ordersByProductTime_.try_emplace({order.product, order.timestamp});
+    auto bucket = emplaced.first;
+    if (memoryBudget_ > 0) pageIn(*bucket);
+    bucket->second.push_back(order);
+    if (memoryBudget_ > 0) pageChanged(*bucket);
+    ++entryCount_;
+    summaries_.addOrder(order);
+    // At the product's latest timestamp (or a later one) the window tables and pyramid update in place;
+    // an insert into the past leaves them stale until buildRangeStats.
+    if (rangeStatsCurrent_ &&
+        !(rangeStats_[order.product].addOrder(order.timestamp, order.price, order.amount) &&
+          pyramids_[order.product].addOrder(order.timestamp, order.price, order.amount))) {
+        rangeStatsCurrent_ = false;
+    }
+    indexOrder(order);
+    indexLevel(order);
+    publishTop(order);
+    if (history_) {
+        if (emplaced.second) history_->startSnapshot(order.product, order.timestamp);  // a new bucket is a full book
+        history_->record(order.product, order.timestamp, order.orderType, order.price, order.amount);
+    }
+    enforceRetention();
+}
+
+// -------- Cancel / fill --------
+// Undo the order's contribution everywhere insertOrder put it: bucket, depth levels, grid ladder,
+// window tables (marked stale), ticker (rescanned), history (negative delta).
+
+bool OrderBook::cancelOrder(const OrderBookEntry& order, const std::string& atTime) {
+    Lock lock(mutex_);
+    return reduceOrder(order, order.amount, atTime);
+}
+
+bool OrderBook::fillOrder(const OrderBookEntry& order, double amount, const std::string& atTime) {
+    Lock lock(mutex_);
+    if (amount <= 0.0) return false;
+    return reduceOrder(order, amount, atTime);
+}
+
+bool OrderBook::reduceOrder(const OrderBookEntry& order, double amount, const std::string& atTime) {
+    auto bucket = ordersByProductTime_.find({order.product, order.timestamp});
+    if (bucket == ordersByProductTime_.end()) return false;
+    pageIn(*bucket);
+    std::vector<OrderBookEntry>& entries = bucket->second;
+    auto it = entries.begin();
+    while (it != entries.end() && !(it->orderType == order.orderType && it->price == order.price &&
+                                    it->amount == order.amount)) {
+        ++it;
+    }
+    if (it == entries.end()) return false;
+
+    const bool removed = amount >= it->amount;
+    const double taken = removed ? it->amount : amount;
+    bool levelShared = false;  // another order rests at the same price: the level must survive
+    for (auto other = entries.begin(); other != entries.end() && !levelShared; ++other) {
+        levelShared = other != it && other->orderType == order.orderType && other->price == order.price;
+    }
+
+    auto depth = depthByProductTime_.find(bucket->first);
+    if (depth != depthByProductTime_.end()) {
+        BPlusTree<double>& side = (order.orderType == OrderBookType::bid) ? depth->second.bids : depth->second.asks;
+        const std::int64_t key = priceKey(order.price);
+        double* level = side.find(key);
+        if (level != nullptr) {
+            *level -= taken;
+            if (removed && !levelShared) side.erase(key);
+        }
+    }
+    auto levels = levelsByProductTime_.find(bucket->first);
+    if (levels != levelsByProductTime_.end() && !levels->second.offGrid) {
+        PriceLevelIndex& side = (order.orderType == OrderBookType::bid) ? levels->second.bids : levels->second.asks;
+        if (removed) side.remove(order.price, taken);
+        else side.reduce(order.price, taken);
+    }
+
+    if (removed) {
+        entries.erase(it);
+        --entryCount_;
+    } else {
+        it->amount -= taken;
+    }
+    if (entries.empty()) {
+        depthByProductTime_.erase(bucket->first);
+        levelsByProductTime_.erase(bucket->first);
+        dropPage(bucket->first);
+        ordersByProductTime_.erase(bucket);  // timestamp stays on the time axis (other products may use it)
+    } else if (memoryBudget_ > 0) {
+        pageChanged(*bucket);
+    }
+    summaries_.refresh(order.product, order.timestamp, findBucket(order.product, order.timestamp));
+    rangeStatsCurrent_ = false;
+    auto ticker = tickers_.find(order.product);
+    if (ticker != tickers_.end()) republishTop(order.product, ticker->second);
+    if (history_) {
+        history_->record(order.product, atTime.empty() ? order.timestamp : atTime, order.orderType, order.price,
+                         -taken);
+    }
+    return true;
+}
+
+// -------- History (see BookHistory.h, docs/orderbook-time.md) --------
+
+void OrderBook::enableHistory(std::size_t checkpointEvery) {
+    Lock lock(mutex_);
+    history_ = std::make_unique<BookHistory>(checkpointEvery);
+    recordHistory();
+}
+
+void OrderBook::recordHistory() {
+    history_->clear();
+    for (auto& kv : ordersByProductTime_) {
+        history_->startSnapshot(kv.first.first, kv.first.second);
+        for (const OrderBookEntry& e : pageIn(kv)) {
+            history_->record(e.product, e.timestamp, e.orderType, e.price, e.amount);
+        }
+    }
+}
+
+BookSnapshot OrderBook::getBookAt(const std::string& product, const std::string& time) const {
+    Lock lock(mutex_);
+    if (!history_) return BookSnapshot{};
+    return history_->stateAt(product, time);
 }
 
 // -------- Slice for matching --------
 // Look up (product, timestamp); return that bucket (bids and asks).
 
 std::vector<OrderBookEntry> OrderBook::matchOrders(const std::string& product, const std::string& timestamp) const {
+    Lock lock(mutex_);
     auto it = ordersByProductTime_.find({product, timestamp});
     if (it == ordersByProductTime_.end()) return {};
-    return it->second;
+    return pageIn(*it);
 }
 
 // -------- Best bid / best ask --------
 // Best bid = highest bid price (buyers compete for priority). Best ask = lowest ask price (sellers).
 // Matching: trade when getBestBid() >= getBestAsk(). Returns 0.0 if no orders on that side.
+// Tick-grid products answer from the ladder (find-first-set); others read the end of the B+tree depth levels.
 
 double OrderBook::getBestBid(const std::string& product, const std::string& timestamp) const {
-    std::vector<OrderBookEntry> bids = getOrders(OrderBookType::bid, product, timestamp);
-    double best = 0.0;
-    for (const OrderBookEntry& e : bids) {
-        if (e.price > best) best = e.price;
+    Lock lock(mutex_);
+    auto levels = levelsByProductTime_.find({product, timestamp});
+    if (levels != levelsByProductTime_.end() && !levels->second.offGrid) {
+        return levels->second.bids.highestPrice();
     }
-    return best;
+    auto depth = depthByProductTime_.find({product, timestamp});
+    if (depth == depthByProductTime_.end() || depth->second.bids.empty()) return 0.0;
+    return priceFromKey((--depth->second.bids.end()).key());
 }
 
 double OrderBook::getBestAsk(const std::string& product, const std::string& timestamp) const {
-    std::vector<OrderBookEntry> asks = getOrders(OrderBookType::ask, product, timestamp);
-    if (asks.empty()) return 0.0;
-    double best = asks[0].price;
-    for (const OrderBookEntry& e : asks) {
-        if (e.price < best) best = e.price;
+    Lock lock(mutex_);
+    auto levels = levelsByProductTime_.find({product, timestamp});
+    if (levels != levelsByProductTime_.end() && !levels->second.offGrid) {
+        return levels->second.asks.lowestPrice();
+    }
+    auto depth = depthByProductTime_.find({product, timestamp});
+    if (depth == depthByProductTime_.end() || depth->second.asks.empty()) return 0.0;
+    return priceFromKey(depth->second.asks.begin().key());
+}
+
+// -------- Depth (see BPlusTree.h) --------
+// Walk one side's levels best-first: bids backwards from the highest key, asks forwards from the lowest.
+// Linked leaves make this a sequential read, not a tree descent per level.
+
+std::vector<PriceLevel> OrderBook::getDepth(OrderBookType type, const std::string& product, const std::string& timestamp,
+                                            std::size_t maxLevels) const {
+    Lock lock(mutex_);
+    std::vector<PriceLevel> out;
+    auto depth = depthByProductTime_.find({product, timestamp});
+    if (depth == depthByProductTime_.end()) return out;
+    if (type == OrderBookType::bid) {
+        const BPlusTree<double>& bids = depth->second.bids;
+        for (auto it = bids.end(); it != bids.begin() && out.size() < maxLevels;) {
+            --it;
+            out.push_back({priceFromKey(it.key()), it.value()});
+        }
+    } else {
+        const BPlusTree<double>& asks = depth->second.asks;
+        for (auto it = asks.begin(); it != asks.end() && out.size() < maxLevels; ++it) {
+            out.push_back({priceFromKey(it.key()), it.value()});
+        }
     }
-    return best;
+    return out;
+}
+
+void OrderBook::indexOrder(const OrderBookEntry& e) {
+    std::int64_t micros;
+    if (TimeKey::parseTimestamp(e.timestamp, micros)) {
+        auto slot = timeAxis_.insert(micros, e.timestamp);
+        if (slot.second) timeAxisFrozen_ = false;  // new timestamp: frozen copy is out of date
+        if (!slot.second && *slot.first != e.timestamp) ++unkeyedTimes_;
+    } else {
+        ++unkeyedTimes_;
+    }
+    DepthLevels& depth = depthByProductTime_[{e.product, e.timestamp}];
+    BPlusTree<double>& side = (e.orderType == OrderBookType::bid) ? depth.bids : depth.asks;
+    side[priceKey(e.price)] += e.amount;
+}
+
+// -------- Tick grid (see PriceLevelIndex.h, docs/trading-market-basics.md) --------
+// A product keeps ladders for its latest bucket only: a ladder is dense (levelCount slots per side), so
+// one per bucket would grow as buckets × levelCount. Older buckets answer from the B+tree depth levels.
+// Registering a grid (re)builds the ladders from the product's latest bucket.
+
+void OrderBook::setTickGrid(const std::string& product, double basePrice, double tickSize, std::size_t levelCount) {
+    Lock lock(mutex_);
+    tickGrids_[product] = TickGrid{basePrice, tickSize, levelCount};
+    levelsByProductTime_.erase(levelsByProductTime_.lower_bound({product, ""}),
+                               levelsByProductTime_.lower_bound({product + std::string(1, '\0'), ""}));
+    auto latest = ordersByProductTime_.lower_bound({product + std::string(1, '\0'), ""});
+    if (latest == ordersByProductTime_.begin() || (--latest)->first.first != product) return;
+    buildLadder(latest->first, tickGrids_[product]);
+}
+
+void OrderBook::indexLevel(const OrderBookEntry& e) {
+    auto grid = tickGrids_.find(e.product);
+    if (grid == tickGrids_.end()) return;
+    const TickGrid& g = grid->second;
+    const ProductTime key{e.product, e.timestamp};
+    auto levels = levelsByProductTime_.lower_bound({e.product, ""});  // the product's one ladder, if any
+    if (levels != levelsByProductTime_.end() && levels->first.first == e.product && levels->first != key) {
+        if (e.timestamp < levels->first.second) return;  // an older bucket: no ladder, depth levels answer
+        levelsByProductTime_.erase(levels);              // a newer bucket replaces the live ladder
+        levels = levelsByProductTime_.end();
+    }
+    if (levels == levelsByProductTime_.end() || levels->first != key) {
+        // The bucket may already hold orders (its ladder was dropped when a newer bucket emptied), so
+        // the new ladder starts from the whole bucket, e included.
+        buildLadder(key, g);
+        return;
+    }
+    GridLevels& gl = levels->second;
+    if (gl.offGrid) return;
+    PriceLevelIndex& side = (e.orderType == OrderBookType::bid) ? gl.bids : gl.asks;
+    if (!side.add(e.price, e.amount)) gl.offGrid = true;  // fall back to scanning this bucket
+}
+
+void OrderBook::buildLadder(const ProductTime& key, const TickGrid& g) {
+    GridLevels& gl = levelsByProductTime_.emplace(key, GridLevels{PriceLevelIndex(g.basePrice, g.tickSize, g.levelCount),
+                                                                  PriceLevelIndex(g.basePrice, g.tickSize, g.levelCount)})
+                         .first->second;
+    auto bucket = ordersByProductTime_.find(key);
+    if (bucket == ordersByProductTime_.end()) return;
+    for (const OrderBookEntry& e : pageIn(*bucket)) {
+        PriceLevelIndex& side = (e.orderType == OrderBookType::bid) ? gl.bids : gl.asks;
+        if (!side.add(e.price, e.amount)) {
+            gl.offGrid = true;
+            return;
+        }
+    }
+}
+
+const std::vector<OrderBookEntry>* OrderBook::findBucket(const std::string& product, const std::string& timestamp) const {
+    auto it = ordersByProductTime_.find({product, timestamp});
+    return (it == ordersByProductTime_.end()) ? nullptr : &pageIn(*it);
+}
+
+// -------- Top-of-book ticker (see TopOfBookTicker.h, docs/trading-market-basics.md) --------
+// The book thread is the only writer. A ticker shows its product's latest timestamp; an order at that
+// timestamp updates it incrementally, a newer timestamp triggers one rescan, an older one is ignored.
+
+const TopOfBookTicker* OrderBook::getTicker(const std::string& product) {
+    Lock lock(mutex_);
+    auto it = tickers_.find(product);
+    if (it == tickers_.end()) {
+        it = tickers_.emplace(product, TickerState{}).first;
+        republishTop(product, it->second);
+    }
+    return it->second.ticker.get();
+}
+
+TopOfBook OrderBook::computeTopOfBook(const std::string& product, const std::string& timestamp) const {
+    TopOfBook top;
+    std::vector<PriceLevel> bids = getDepth(OrderBookType::bid, product, timestamp, 1);
+    std::vector<PriceLevel> asks = getDepth(OrderBookType::ask, product, timestamp, 1);
+    if (!bids.empty()) {
+        top.bidPrice = bids[0].price;
+        top.bidSize = bids[0].amount;
+    }
+    if (!asks.empty()) {
+        top.askPrice = asks[0].price;
+        top.askSize = asks[0].amount;
+    }
+    return top;
+}
+
+void OrderBook::publishTop(const OrderBookEntry& order) {
+    auto it = tickers_.find(order.product);
+    if (it == tickers_.end()) return;  // nobody asked for this product's ticker
+    TickerState& state = it->second;
+    if (order.timestamp < state.timestamp) return;
+    if (order.timestamp > state.timestamp) {
+        state.timestamp = order.timestamp;
+        state.top = computeTopOfBook(order.product, order.timestamp);
+    } else if (order.orderType == OrderBookType::bid) {
+        if (state.top.bidSize == 0.0 || order.price > state.top.bidPrice) {
+            state.top.bidPrice = order.price;
+            state.top.bidSize = order.amount;
+        } else if (order.price == state.top.bidPrice) {
+            state.top.bidSize += order.amount;
+        } else {
+            return;  // below the best bid: top unchanged, nothing to publish
+        }
+    } else {
+        if (state.top.askSize == 0.0 || order.price < state.top.askPrice) {
+            state.top.askPrice = order.price;
+            state.top.askSize = order.amount;
+        } else if (order.price == state.top.askPrice) {
+            state.top.askSize += order.amount;
+        } else {
+            return;
+        }
+    }
+    state.ticker->publish(state.top);
+}
+
+void OrderBook::republishTop(const std::string& product, TickerState& state) {
+    state.timestamp.clear();
+    for (auto b = ordersByProductTime_.lower_bound({product, ""});
+         b != ordersByProductTime_.end() && b->first.first == product; ++b) {
+        state.timestamp = b->first.second;  // keys are sorted, so the last one is the latest
+    }
+    state.top = state.timestamp.empty() ? TopOfBook{} : computeTopOfBook(product, state.timestamp);
+    state.ticker->publish(state.top);
+}
+
+void OrderBook::publishAllTops() {
+    for (auto& kv : tickers_) republishTop(kv.first, kv.second);
 }
 
 // -------- getAllEntries --------
 // Flat vector of all entries (for stats: computeAveragePrice, etc.).
 
 std::vector<OrderBookEntry> OrderBook::getAllEntries() const {
+    Lock lock(mutex_);
     std::vector<OrderBookEntry> out;
-    for (const auto& kv : ordersByProductTime_) {
-        for (const OrderBookEntry& e : kv.second) {
+    for (auto& kv : ordersByProductTime_) {
+        for (const OrderBookEntry& e : pageIn(kv)) {
             out.push_back(e);
         }
     }
     return out;
 }
 
+// -------- Query (see OrderQuery.h, docs/orderbook-matching.md) --------
+// Buckets are pruned by key (queryBuckets): per product, jump to (product, from) and stop after to.
+// Surviving buckets are copied into column batches (only the columns the query reads), selected, and
+// the passing rows are taken from the bucket by index.
+
+std::vector<OrderBookEntry> OrderBook::query(const OrderQuery& q) const {
+    Lock lock(mutex_);
+    std::vector<OrderBookEntry> out;
+    runQuery(q, &out);
+    return out;
+}
+
+std::size_t OrderBook::countMatching(const OrderQuery& q) const {
+    Lock lock(mutex_);
+    return runQuery(q, nullptr);
+}
+
+std::size_t OrderBook::runQuery(const OrderQuery& q, std::vector<OrderBookEntry>* out) const {
+    std::size_t matched = 0;
+    OrderBatch batch;
+    for (Buckets::iterator it : queryBuckets(q)) {
+        const std::vector<OrderBookEntry>& entries = pageIn(*it);
+        for (std::size_t begin = 0; begin < entries.size(); begin += OrderBatch::kRows) {
+            const OrderBookEntry* rows = entries.data() + begin;
+            const std::size_t k = q.selectEntries(rows, std::min(OrderBatch::kRows, entries.size() - begin), batch);
+            matched += k;
+            if (out) for (std::size_t j = 0; j < k; ++j) out->push_back(rows[batch.sel[j]]);
+        }
+    }
+    return matched;
+}
+
+std::vector<OrderBook::Buckets::iterator> OrderBook::queryBuckets(const OrderQuery& q) const {
+    std::vector<Buckets::iterator> selected;
+    if (q.matchesNothing()) return selected;
+    auto it = ordersByProductTime_.lower_bound({q.getProduct(), q.getFrom()});
+    while (it != ordersByProductTime_.end()) {
+        const std::string& product = it->first.first;
+        if (!q.getProduct().empty() && product != q.getProduct()) break;
+        if (!q.getTo().empty() && it->first.second > q.getTo()) {  // past the window: next product
+            it = ordersByProductTime_.lower_bound({product + std::string(1, '\0'), q.getFrom()});
+            continue;
+        }
+        if (it->first.second < q.getFrom()) {  // first bucket of a new product, before the window
+            it = ordersByProductTime_.lower_bound({product, q.getFrom()});
+            continue;
+        }
+        selected.push_back(it++);
+    }
+    return selected;
+}
+
+// -------- Group-by (see GroupBy.h, docs/orderbook-statistics.md) --------
+// The calling thread resolves each bucket's product id and time-bucket id and pages the bucket in; the
+// aggregator's workers only read. Under a memory budget the buckets go in rounds of about half the
+// budget; each is pinned as it is paged in (pinPage), so a later, larger bucket of the same round cannot
+// page it out before the workers have read it.
+
+std::vector<GroupRow> OrderBook::groupBy(const GroupBySpec& spec, const OrderQuery& filter, unsigned threads) const {
+    Lock lock(mutex_);
+    GroupAggregator aggregator(spec.bySide, filter, threads);
+    std::vector<std::string> products, times;
+    std::map<std::int64_t, std::uint32_t> timeIds;
+    std::map<std::string, std::uint32_t> rawTimeIds;  // timestamps TimeKey cannot parse group as they are
+    std::vector<GroupInput> round;
+    std::size_t roundBytes = 0;
+    for (Buckets::iterator it : queryBuckets(filter)) {
+        GroupInput in;
+        if (spec.byProduct) {
+            if (products.empty() || products.back() != it->first.first) products.push_back(it->first.first);
+            in.product = static_cast<std::uint32_t>(products.size() - 1);
+        }
+        if (spec.timeBucket > 0) {
+            std::int64_t micros = 0;
+            const auto id = static_cast<std::uint32_t>(times.size());
+            if (TimeKey::parseTimestamp(it->first.second, micros)) {
+                const std::int64_t start = micros - micros % spec.timeBucket;
+                auto known = timeIds.emplace(start, id);
+                if (known.second) times.push_back(TimeKey::formatTimestamp(start));
+                in.time = known.first->second;
+            } else {
+                auto known = rawTimeIds.emplace(it->first.second, id);
+                if (known.second) times.push_back(it->first.second);
+                in.time = known.first->second;
+            }
+        }
+        in.orders = &pinPage(*it);
+        round.push_back(in);
+        roundBytes += (memoryBudget_ > 0) ? bucketBytes(*in.orders) : 0;
+        if (memoryBudget_ > 0 && roundBytes > memoryBudget_ / 2) {
+            aggregator.add(round);
+            unpinPages();
+            round.clear();
+            roundBytes = 0;
+        }
+    }
+    aggregator.add(round);
+    unpinPages();
+    return aggregator.finish(products, times);
+}
+
+// -------- Top K orders (see TopOrders.h, docs/orderbook-statistics.md) --------
+// Product ids and bucket sequence numbers are handed out in map order, so ties break by book position.
+// Paging rounds (pinned) as in groupBy.
+
+std::vector<OrderBookEntry> OrderBook::topOrders(const TopOrdersSpec& spec, const OrderQuery& filter, unsigned threads) const {
+    Lock lock(mutex_);
+    TopOrderSelector selector(spec, filter, threads);
+    std::uint32_t products = 0, sequence = 0;
+    std::string lastProduct;
+    std::vector<TopOrderInput> round;
+    std::size_t roundBytes = 0;
+    for (Buckets::iterator it : queryBuckets(filter)) {
+        TopOrderInput in;
+        if (spec.perProduct) {
+            if (products == 0 || lastProduct != it->first.first) {
+                lastProduct = it->first.first;
+                ++products;
+            }
+            in.product = products - 1;
+        }
+        in.sequence = sequence++;
+        in.orders = &pinPage(*it);
+        round.push_back(in);
+        roundBytes += (memoryBudget_ > 0) ? bucketBytes(*in.orders) : 0;
+        if (memoryBudget_ > 0 && roundBytes > memoryBudget_ / 2) {
+            selector.add(round);
+            unpinPages();
+            round.clear();
+            roundBytes = 0;
+        }
+    }
+    selector.add(round);
+    unpinPages();
+    return selector.finish();
+}
+
+// -------- Heatmap (see Heatmap.h, docs/trading-market-basics.md) --------
+// A product's buckets are contiguous and time-sorted, so their columns never go back: the column list is
+// built in one pass, and the inputs are already sorted by column for Heatmap::fill's tiles. Paging rounds
+// (pinned) as in groupBy.
+
+Heatmap OrderBook::buildHeatmap(const HeatmapSpec& spec, unsigned threads) const {
+    Lock lock(mutex_);
+    OrderQuery window;
+    window.product(spec.product).between(spec.from, spec.to);
+    const std::vector<Buckets::iterator> buckets = spec.product.empty() ? std::vector<Buckets::iterator>()
+                                                                        : queryBuckets(window);
+    if (buckets.empty()) return Heatmap();
+
+    double low = spec.priceLow, high = spec.priceHigh;
+    if (!(high > low)) {
+        const WindowStats stats = getWindowStats(spec.product, buckets.front()->first.second, buckets.back()->first.second);
+        low = stats.low;
+        high = stats.high;
+    }
+
+    std::vector<std::string> labels;
+    std::vector<std::int64_t> starts;
+    std::vector<std::size_t> columnOf(buckets.size());
+    for (std::size_t b = 0; b < buckets.size(); ++b) {
+        const std::string& t = buckets[b]->first.second;
+        std::int64_t micros = 0;
+        const bool parsed = TimeKey::parseTimestamp(t, micros);
+        if (spec.timeBucket > 0 && parsed) {
+            const std::int64_t start = micros - micros % spec.timeBucket;
+            if (starts.empty() || starts.back() != start) {
+                starts.push_back(start);
+                labels.push_back(TimeKey::formatTimestamp(start));
+            }
+        } else {  // per timestamp (or a timestamp TimeKey cannot parse: a column of its own)
+            starts.push_back(parsed ? micros : 0);
+            labels.push_back(t);
+        }
+        columnOf[b] = labels.size() - 1;
+    }
+
+    Heatmap heatmap(spec.product, std::move(labels), std::move(starts), spec.priceBins, low, high);
+    std::vector<HeatmapInput> round;
+    std::size_t roundBytes = 0;
+    for (std::size_t b = 0; b < buckets.size(); ++b) {
+        HeatmapInput in;
+        in.orders = &pinPage(*buckets[b]);
+        in.column = columnOf[b];
+        round.push_back(in);
+        roundBytes += (memoryBudget_ > 0) ? bucketBytes(*in.orders) : 0;
+        if (memoryBudget_ > 0 && roundBytes > memoryBudget_ / 2) {
+            heatmap.fill(round, threads);
+            unpinPages();
+            round.clear();
+            roundBytes = 0;
+        }
+    }
+    heatmap.fill(round, threads);
+    unpinPages();
+    heatmap.finish();
+    return heatmap;
+}
+
 // -------- All entries at one timestamp --------
 std::vector<OrderBookEntry> OrderBook::getAllEntriesAtTime(const std::string& timestamp) const {
+    Lock lock(mutex_);
     std::vector<OrderBookEntry> out;
-    for (const auto& kv : ordersByProductTime_) {
+    for (auto& kv : ordersByProductTime_) {
         if (kv.first.second == timestamp) {
-            for (const OrderBookEntry& e : kv.second) {
+            for (const OrderBookEntry& e : pageIn(kv)) {
                 out.push_back(e);
             }
         }
@@ -119,19 +789,591 @@ std::vector<OrderBookEntry> OrderBook::getAllEntriesAtTime(const std::string& ti
     return out;
 }
 
-// -------- Time helpers (delegate to OrderBookEntry free functions) --------
+// -------- Time helpers (see docs/orderbook-time.md) --------
+// Frozen (after load): branchless Eytzinger search over an array. Otherwise: O(log n) on the B+tree
+// timeAxis_. If any timestamp could not be keyed, fall back to the OrderBookEntry free functions over
+// getAllEntries() so answers stay exact.
+
 std::string OrderBook::getEarliestTime() const {
-    return ::getEarliestTime(getAllEntries());
+    Lock lock(mutex_);
+    if (unkeyedTimes_ > 0) return ::getEarliestTime(getAllEntries());
+    return timeAxis_.empty() ? "" : timeAxis_.begin().value();
 }
 
 std::string OrderBook::getLatestTime() const {
-    return ::getLatestTime(getAllEntries());
+    Lock lock(mutex_);
+    if (unkeyedTimes_ > 0) return ::getLatestTime(getAllEntries());
+    return timeAxis_.empty() ? "" : (--timeAxis_.end()).value();
 }
 
 std::string OrderBook::getNextTime(const std::string& currentTime) const {
-    return ::getNextTime(currentTime, getAllEntries());
+    Lock lock(mutex_);
+    std::int64_t micros;
+    if (unkeyedTimes_ > 0 || !TimeKey::parseTimestamp(currentTime, micros)) {
+        return ::getNextTime(currentTime, getAllEntries());
+    }
+    if (timeAxisFrozen_) {
+        const std::size_t i = frozenTimeIndex_.upperBound(micros);
+        return (i < frozenTimes_.size()) ? frozenTimes_[i] : "";
+    }
+    auto it = timeAxis_.upperBound(micros);
+    return (it != timeAxis_.end()) ? it.value() : "";
 }
 
 std::string OrderBook::getPreviousTime(const std::string& currentTime) const {
-    return ::getPreviousTime(currentTime, getAllEntries());
+    Lock lock(mutex_);
+    std::int64_t micros;
+    if (unkeyedTimes_ > 0 || !TimeKey::parseTimestamp(currentTime, micros)) {
+        return ::getPreviousTime(currentTime, getAllEntries());
+    }
+    if (timeAxisFrozen_) {
+        const std::size_t i = frozenTimeIndex_.lowerBound(micros);  // first >= currentTime
+        return (i == 0) ? "" : frozenTimes_[i - 1];
+    }
+    auto it = timeAxis_.lowerBound(micros);  // first >= currentTime
+    if (it == timeAxis_.begin()) return "";
+    return (--it).value();
+}
+
+std::vector<std::string> OrderBook::getTimesBetween(const std::string& from, const std::string& to) const {
+    Lock lock(mutex_);
+    std::vector<std::string> out;
+    std::int64_t lo, hi;
+    if (unkeyedTimes_ > 0 || !TimeKey::parseTimestamp(from, lo) || !TimeKey::parseTimestamp(to, hi)) {
+        std::set<std::string> timestamps;
+        for (const auto& kv : ordersByProductTime_) {
+            if (kv.first.second >= from && kv.first.second <= to) timestamps.insert(kv.first.second);
+        }
+        return std::vector<std::string>(timestamps.begin(), timestamps.end());
+    }
+    if (timeAxisFrozen_) {
+        const std::size_t first = frozenTimeIndex_.lowerBound(lo);
+        const std::size_t last = frozenTimeIndex_.upperBound(hi);
+        if (first < last) out.assign(frozenTimes_.begin() + first, frozenTimes_.begin() + last);
+        return out;
+    }
+    for (auto it = timeAxis_.lowerBound(lo); it != timeAxis_.end() && it.key() <= hi; ++it) {
+        out.push_back(it.value());
+    }
+    return out;
+}
+
+void OrderBook::freezeTimeAxis() {
+    Lock lock(mutex_);
+    std::vector<std::int64_t> keys;
+    keys.reserve(timeAxis_.size());
+    frozenTimes_.clear();
+    frozenTimes_.reserve(timeAxis_.size());
+    for (auto it = timeAxis_.begin(); it != timeAxis_.end(); ++it) {
+        keys.push_back(it.key());
+        frozenTimes_.push_back(it.value());
+    }
+    frozenTimeIndex_ = EytzingerIndex(keys);
+    timeAxisFrozen_ = true;
+}
+
+// -------- Summary table (see SummaryTable.h, docs/orderbook-statistics.md) --------
+
+SummaryRow OrderBook::getSummary(const std::string& product, const std::string& timestamp) const {
+    Lock lock(mutex_);
+    const SummaryRow* row = summaries_.find(product, timestamp);
+    return row ? *row : SummaryRow{};
+}
+
+std::vector<SummaryRow> OrderBook::getSummariesAtTime(const std::string& timestamp) const {
+    Lock lock(mutex_);
+    return summaries_.rowsAt(timestamp);
+}
+
+SummaryRow OrderBook::getTimeSummary(const std::string& timestamp) const {
+    Lock lock(mutex_);
+    return summaries_.combinedAt(timestamp);
+}
+
+// -------- As-of join (see AsOfJoin.h, docs/orderbook-time.md) --------
+
+std::vector<AsOfQuote> OrderBook::asOfJoin(const std::vector<AsOfEvent>& events) const {
+    Lock lock(mutex_);
+    return AsOfJoin::join(summaries_.rows(), events);
+}
+
+std::vector<AsOfQuote> OrderBook::asOfJoin(const std::string& product, const std::vector<std::string>& timestamps) const {
+    std::vector<AsOfEvent> events;
+    events.reserve(timestamps.size());
+    for (const std::string& t : timestamps) events.push_back({t, product});
+    return asOfJoin(events);
+}
+
+// -------- Execution simulation (see ExecutionSimulator.h, docs/orderbook-matching.md) --------
+// Depth comes from depthByProductTime_ (already aggregated per price, never paged out). One window per
+// product covers all of its parents; only the copy is held under the lock.
+
+std::vector<ExecutionReport> OrderBook::simulateExecutions(const std::vector<ParentOrder>& parents, unsigned threads) const {
+    std::map<std::string, std::pair<std::string, std::string>> windows;  // product → [from, to]; "" = open
+    for (const ParentOrder& p : parents) {
+        auto slot = windows.try_emplace(p.product, p.from, p.to);
+        if (slot.second) continue;
+        std::pair<std::string, std::string>& w = slot.first->second;
+        if (p.from.empty() || p.from < w.first) w.first = p.from;
+        if (!w.second.empty() && (p.to.empty() || p.to > w.second)) w.second = p.to;
+    }
+
+    ExecutionSimulator market;
+    {
+        Lock lock(mutex_);
+        for (const auto& w : windows) {
+            for (auto it = depthByProductTime_.lower_bound({w.first, w.second.first});
+                 it != depthByProductTime_.end() && it->first.first == w.first &&
+                 (w.second.second.empty() || it->first.second <= w.second.second);
+                 ++it) {
+                ExecutionStep step;
+                step.timestamp = it->first.second;
+                const BPlusTree<double>& bids = it->second.bids;
+                for (auto level = bids.end(); level != bids.begin();) {
+                    --level;
+                    step.bids.push_back({priceFromKey(level.key()), level.value()});
+                    step.volume += level.value();
+                }
+                for (auto level = it->second.asks.begin(); level != it->second.asks.end(); ++level) {
+                    step.asks.push_back({priceFromKey(level.key()), level.value()});
+                    step.volume += level.value();
+                }
+                market.addStep(w.first, std::move(step));
+            }
+        }
+    }
+    return market.simulateAll(parents, threads);
+}
+
+// -------- Retention (see docs/orderbook-retention.md) --------
+// Partitions are whole (product, timestamp) buckets. Map keys sort by product then time, so "everything
+// of product p older than cutoff" is one contiguous key range: erase(first, last) frees it in one call
+// instead of one tree erase per order. The cost is O(evicted partitions + products * log n).
+
+void OrderBook::setRetention(const RetentionPolicy& policy) {
+    Lock lock(mutex_);
+    retention_ = policy;
+    enforceRetention();
+}
+
+void OrderBook::enforceRetention() {
+    if ((retention_.maxTimestamps == 0 && retention_.maxAgeMicros == 0) || timeAxis_.empty()) return;
+    std::int64_t cutoffKey = std::numeric_limits<std::int64_t>::min();
+    if (retention_.maxTimestamps > 0 && timeAxis_.size() > retention_.maxTimestamps) {
+        auto first = timeAxis_.begin();
+        for (std::size_t skip = timeAxis_.size() - retention_.maxTimestamps; skip > 0; --skip) ++first;
+        cutoffKey = first.key();
+    }
+    if (retention_.maxAgeMicros > 0) {
+        cutoffKey = std::max(cutoffKey, (--timeAxis_.end()).key() - retention_.maxAgeMicros);
+    }
+    if (timeAxis_.begin().key() >= cutoffKey) return;
+    evictBefore(timeAxis_.lowerBound(cutoffKey).value());  // the newest key is >= cutoffKey, so this exists
+}
+
+std::size_t OrderBook::evictBefore(const std::string& cutoff) {
+    Lock lock(mutex_);
+    std::ofstream spill;
+    if (!retention_.spillPath.empty()) {
+        spill.open(retention_.spillPath, std::ios::binary | std::ios::app);
+        if (!spill.is_open()) std::cerr << "Could not open spill file: " << retention_.spillPath << std::endl;
+    }
+    std::size_t evicted = 0;
+    for (auto first = ordersByProductTime_.begin(); first != ordersByProductTime_.end();) {
+        const std::string product = first->first.first;
+        auto last = ordersByProductTime_.lower_bound({product, cutoff});
+        for (auto b = first; b != last; ++b) {
+            const SummaryRow* row = summaries_.find(product, b->first.second);  // the bucket may be paged out
+            evicted += row ? row->count : 0;
+            if (spill.is_open()) BinaryIO::writePartition(spill, product, b->first.second, pageIn(*b));
+            dropPage(b->first);
+        }
+        if (first != last) {
+            depthByProductTime_.erase(depthByProductTime_.lower_bound({product, ""}),
+                                      depthByProductTime_.lower_bound({product, cutoff}));
+            levelsByProductTime_.erase(levelsByProductTime_.lower_bound({product, ""}),
+                                       levelsByProductTime_.lower_bound({product, cutoff}));
+            ordersByProductTime_.erase(first, last);
+        }
+        // Next product: (product + '\0', "") sorts after every (product, t) key and before any other product.
+        first = ordersByProductTime_.lower_bound({product + std::string(1, '\0'), ""});
+    }
+
+    std::int64_t cutoffKey;
+    if (TimeKey::parseTimestamp(cutoff, cutoffKey)) {
+        std::vector<std::int64_t> oldKeys;
+        for (auto t = timeAxis_.begin(); t != timeAxis_.end() && t.key() < cutoffKey; ++t) oldKeys.push_back(t.key());
+        for (std::int64_t key : oldKeys) timeAxis_.erase(key);
+        // erase() leaves empty leaves behind; once they dominate, rebuild so begin() stays O(1).
+        if (timeAxis_.leafCount() > 4 * (timeAxis_.size() / BPlusTreeDetail::kFanout + 1)) {
+            BPlusTree<std::string> compact;
+            for (auto t = timeAxis_.begin(); t != timeAxis_.end(); ++t) compact.insert(t.key(), t.value());
+            timeAxis_ = std::move(compact);
+        }
+    }
+    timeAxisFrozen_ = false;
+    summaries_.eraseBefore(cutoff);
+    rangeStatsCurrent_ = false;
+    entryCount_ -= evicted;
+    for (auto& kv : tickers_) {
+        if (!kv.second.timestamp.empty() && kv.second.timestamp < cutoff) republishTop(kv.first, kv.second);
+    }
+    return evicted;
+}
+
+// -------- Export (see docs/orderbook-loading.md) --------
+// Rounds: the main thread picks the next buckets (paging them in), cut into one slice per worker of
+// about kExportRowsPerThread rows; workers format their slices into their own buffers; then the round's
+// buffers are written in slice order. Memory stays at ~threads x slice, whatever the export size.
+
+std::size_t OrderBook::exportOrders(const std::string& path, const ExportFilter& filter, ExportFormat format,
+                                    unsigned threads) const {
+    constexpr std::size_t kExportRowsPerThread = 1u << 16;
+    Lock lock(mutex_);
+
+    // Buckets of the filter, in time order then product order, like the CSV the book was loaded from.
+    std::vector<Buckets::iterator> selected;
+    auto it = filter.product.empty() ? ordersByProductTime_.begin()
+                                     : ordersByProductTime_.lower_bound({filter.product, filter.from});
+    for (; it != ordersByProductTime_.end(); ++it) {
+        if (!filter.product.empty() && it->first.first != filter.product) break;
+        const std::string& t = it->first.second;
+        if ((!filter.from.empty() && t < filter.from) || (!filter.to.empty() && t > filter.to)) continue;
+        selected.push_back(it);
+    }
+    std::stable_sort(selected.begin(), selected.end(), [](Buckets::iterator a, Buckets::iterator b) {
+        return a->first.second < b->first.second;
+    });
+
+    OrderedFileWriter writer;
+    if (!writer.open(path)) return 0;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<std::string> buffers(threads);
+    std::vector<std::size_t> rows(threads);
+    std::vector<std::size_t> sliceStart;
+    std::size_t written = 0;
+    for (std::size_t next = 0; next < selected.size();) {
+        // Cut one round of about half the budget. Each bucket is pinned as it is paged in, so paging in
+        // a later (possibly bigger) bucket cannot page out an earlier one before the workers read it. The
+        // bucket that ends the round is pinned too but left for the next round.
+        sliceStart.assign(1, next);
+        std::size_t sliceRows = 0, roundBytes = 0;
+        for (; next < selected.size() && sliceStart.size() <= threads; ++next) {
+            const std::vector<OrderBookEntry>& bucket = pinPage(*selected[next]);
+            roundBytes += (memoryBudget_ > 0) ? bucketBytes(bucket) : 0;
+            sliceRows += bucket.size();
+            if (memoryBudget_ > 0 && roundBytes > memoryBudget_ / 2 && next > sliceStart.front()) break;
+            if (sliceRows >= kExportRowsPerThread) {
+                sliceStart.push_back(next + 1);
+                sliceRows = 0;
+            }
+        }
+        if (sliceStart.back() != next) sliceStart.push_back(next);
+        const std::size_t slices = sliceStart.size() - 1;
+
+        std::vector<std::thread> workers;
+        for (std::size_t s = 0; s < slices; ++s) {
+            workers.emplace_back([&, s]() {
+                std::string& out = buffers[s];
+                out.clear();
+                rows[s] = 0;
+                std::vector<OrderBookEntry> sides;
+                for (std::size_t b = sliceStart[s]; b < sliceStart[s + 1]; ++b) {
+                    const ProductTime& key = selected[b]->first;
+                    const std::vector<OrderBookEntry>& entries = selected[b]->second;  // pinned above
+                    if (format == ExportFormat::csv) {
+                        rows[s] += ExportWriter::appendCSV(out, entries, filter.bids, filter.asks);
+                        continue;
+                    }
+                    const std::vector<OrderBookEntry>* block = &entries;
+                    if (!filter.bids || !filter.asks) {
+                        sides.clear();
+                        for (const OrderBookEntry& e : entries) {
+                            if (e.orderType == OrderBookType::bid ? filter.bids : filter.asks) sides.push_back(e);
+                        }
+                        block = &sides;
+                    }
+                    if (block->empty()) continue;
+                    BinaryIO::appendPartition(out, key.first, key.second, *block);
+                    rows[s] += block->size();
+                }
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+        unpinPages();
+        if (!writer.write(buffers.data(), slices)) return 0;
+        for (std::size_t s = 0; s < slices; ++s) written += rows[s];
+    }
+    return writer.close() ? written : 0;
+}
+
+// -------- Memory budget (see docs/orderbook-retention.md) --------
+// Unit of paging = one (product, timestamp) bucket. A paged-out bucket keeps its map key with an empty
+// vector, so key-only walks (getKnownProducts, time helpers, tickers) never touch the disk; readers of
+// the orders go through pageIn(). Depth levels, ladders, summary rows and the time axis stay resident:
+// they are per price level / per bucket, far smaller than the orders themselves.
+// Without a page file (empty spillFile) a paged-out bucket is held as CompressedColumns in its Page:
+// encoded on page-out, decoded and released on page-in, so each bucket has exactly one live copy.
+
+bool OrderBook::setMemoryBudget(std::size_t budgetBytes, const std::string& spillFile) {
+    Lock lock(mutex_);
+    if (memoryBudget_ > 0) memoryBudget_ = std::numeric_limits<std::size_t>::max();  // page in, evict nothing
+    for (auto& kv : ordersByProductTime_) pageIn(kv);  // start from everything resident
+    memoryBudget_ = 0;
+    pages_.clear();
+    lru_.clear();
+    pinned_.clear();
+    residentBytes_ = 0;
+    compressedBytes_ = 0;
+    if (pageFile_.is_open()) pageFile_.close();
+    pageFilePath_.clear();
+    if (budgetBytes == 0) return true;
+
+    if (!spillFile.empty()) {
+        pageFile_.open(spillFile, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!pageFile_.is_open()) {
+            std::cerr << "Could not open page file: " << spillFile << std::endl;
+            return false;
+        }
+    }
+    pageFilePath_ = spillFile;
+    memoryBudget_ = budgetBytes;
+    resetPaging();
+    return true;
+}
+
+std::size_t OrderBook::getResidentBytes() const {
+    Lock lock(mutex_);
+    return residentBytes_;
+}
+
+std::size_t OrderBook::getPagedOutPartitions() const {
+    Lock lock(mutex_);
+    return pages_.size() - lru_.size();
+}
+
+std::size_t OrderBook::getCompressedBytes() const {
+    Lock lock(mutex_);
+    return compressedBytes_;
+}
+
+void OrderBook::resetPaging() {
+    pages_.clear();
+    lru_.clear();
+    pinned_.clear();
+    residentBytes_ = 0;
+    compressedBytes_ = 0;
+    if (memoryBudget_ == 0) return;
+    if (!pageFilePath_.empty()) {
+        pageFile_.close();
+        pageFile_.open(pageFilePath_, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    }
+    // Oldest timestamps first in the LRU list, so a fresh load pages out old history before new.
+    std::vector<Buckets::iterator> byTime;
+    for (auto it = ordersByProductTime_.begin(); it != ordersByProductTime_.end(); ++it) byTime.push_back(it);
+    std::stable_sort(byTime.begin(), byTime.end(), [](Buckets::iterator a, Buckets::iterator b) {
+        return a->first.second < b->first.second;
+    });
+    for (Buckets::iterator it : byTime) pageChanged(*it);
+}
+
+std::size_t OrderBook::bucketBytes(const std::vector<OrderBookEntry>& entries) {
+    std::size_t bytes = entries.capacity() * sizeof(OrderBookEntry);
+    for (const OrderBookEntry& e : entries) bytes += e.product.capacity() + e.timestamp.capacity();
+    return bytes;  // estimate: ignores allocator overhead; short strings are counted though inline
+}
+
+const std::vector<OrderBookEntry>& OrderBook::pageIn(Buckets::value_type& bucket) const {
+    if (memoryBudget_ == 0) return bucket.second;
+    auto page = pages_.find(bucket.first);
+    if (page == pages_.end()) return bucket.second;
+    Page& p = page->second;
+    if (p.resident) {
+        if (!p.pinned) lru_.splice(lru_.end(), lru_, p.lru);  // most recently used
+        return bucket.second;
+    }
+    if (pageFilePath_.empty()) {
+        p.cold.decode(bucket.second);
+        compressedBytes_ -= p.cold.byteSize();
+        p.cold.clear();
+    } else {
+        std::string product, timestamp;
+        pageFile_.clear();
+        pageFile_.seekg(p.offset);
+        if (!BinaryIO::readPartition(pageFile_, product, timestamp, bucket.second)) {
+            std::cerr << "Could not page in " << bucket.first.first << " @ " << bucket.first.second << std::endl;
+        }
+    }
+    p.resident = true;
+    p.bytes = bucketBytes(bucket.second);
+    p.lru = lru_.insert(lru_.end(), bucket.first);
+    residentBytes_ += p.bytes;
+    enforceBudget();
+    return bucket.second;
+}
+
+// A round pins its buckets as it pages them in: an unpinned bucket could be paged out by the page-in of
+// a later, larger one while the round still holds a reference to its (then emptied) vector.
+
+const std::vector<OrderBookEntry>& OrderBook::pinPage(Buckets::value_type& bucket) const {
+    const std::vector<OrderBookEntry>& entries = pageIn(bucket);
+    if (memoryBudget_ == 0) return entries;
+    auto page = pages_.find(bucket.first);
+    if (page != pages_.end() && page->second.resident && !page->second.pinned) {
+        lru_.erase(page->second.lru);
+        page->second.pinned = true;
+        pinned_.push_back(bucket.first);
+    }
+    return entries;
+}
+
+void OrderBook::unpinPages() const {
+    if (pinned_.empty()) return;
+    for (const ProductTime& key : pinned_) {
+        auto page = pages_.find(key);
+        if (page == pages_.end() || !page->second.pinned) continue;
+        page->second.pinned = false;
+        page->second.lru = lru_.insert(lru_.end(), key);
+    }
+    pinned_.clear();
+    enforceBudget();
+}
+
+void OrderBook::pageChanged(Buckets::value_type& bucket) {
+    Page& p = pages_[bucket.first];
+    if (p.resident) {
+        residentBytes_ -= p.bytes;
+        if (!p.pinned) lru_.splice(lru_.end(), lru_, p.lru);
+    } else {
+        p.resident = true;
+        p.lru = lru_.insert(lru_.end(), bucket.first);
+    }
+    p.dirty = true;
+    p.bytes = bucketBytes(bucket.second);
+    residentBytes_ += p.bytes;
+    enforceBudget();
+}
+
+void OrderBook::dropPage(const ProductTime& key) {
+    auto page = pages_.find(key);
+    if (page == pages_.end()) return;
+    if (page->second.resident) {
+        residentBytes_ -= page->second.bytes;
+        if (!page->second.pinned) lru_.erase(page->second.lru);
+    }
+    compressedBytes_ -= page->second.cold.byteSize();
+    pages_.erase(page);  // its bytes in the page file become dead space until the next reset
+}
+
+void OrderBook::enforceBudget() const {
+    // Never page out the most recently used bucket: the caller is about to read it.
+    while (residentBytes_ > memoryBudget_ && lru_.size() > 1) {
+        const ProductTime key = lru_.front();
+        lru_.pop_front();
+        Page& p = pages_[key];
+        std::vector<OrderBookEntry>& entries = ordersByProductTime_[key];
+        if (pageFilePath_.empty()) {
+            p.cold.encode(entries);
+            compressedBytes_ += p.cold.byteSize();
+        } else if (p.dirty || p.offset < 0) {  // clean pages already have an up-to-date copy on disk
+            pageFile_.clear();
+            pageFile_.seekp(0, std::ios::end);
+            p.offset = static_cast<std::int64_t>(pageFile_.tellp());
+            BinaryIO::writePartition(pageFile_, key.first, key.second, entries);
+            pageFile_.flush();
+            p.dirty = false;
+        }
+        std::vector<OrderBookEntry>().swap(entries);  // release the capacity, not just the size
+        residentBytes_ -= p.bytes;
+        p.resident = false;
+    }
+}
+
+BucketStats OrderBook::bucketStats(Buckets::value_type& bucket) const {
+    if (memoryBudget_ > 0 && pageFilePath_.empty()) {
+        auto page = pages_.find(bucket.first);
+        if (page != pages_.end() && !page->second.resident) return page->second.cold.stats();  // no page-in, no LRU churn
+    }
+    BucketStats stats;
+    for (const OrderBookEntry& e : pageIn(bucket)) stats.add(e.price, e.amount);
+    return stats;
+}
+
+// -------- Window stats (see RangeStats.h, docs/orderbook-statistics.md) --------
+// Map keys are (product, timestamp), so one product's buckets are contiguous and already time-sorted:
+// a single pass appends them to that product's tables and to the 1s level of its chart pyramid.
+
+void OrderBook::buildRangeStats() {
+    Lock lock(mutex_);
+    rangeStats_.clear();
+    pyramids_.clear();
+    for (auto& kv : ordersByProductTime_) {
+        const BucketStats stats = bucketStats(kv);
+        rangeStats_[kv.first.first].append(kv.first.second, stats);
+        pyramids_[kv.first.first].append(kv.first.second, stats);
+    }
+    for (auto& kv : rangeStats_) kv.second.finish();
+    for (auto& kv : pyramids_) kv.second.finish();
+    rangeStatsCurrent_ = true;
+}
+
+WindowStats OrderBook::getWindowStats(const std::string& product, const std::string& from, const std::string& to) const {
+    Lock lock(mutex_);
+    if (rangeStatsCurrent_) {
+        auto it = rangeStats_.find(product);
+        return (it == rangeStats_.end()) ? WindowStats{} : it->second.query(from, to);
+    }
+    // Stale tables: same answer by scanning the window's buckets.
+    ProductRangeStats window;
+    for (auto it = ordersByProductTime_.lower_bound({product, from});
+         it != ordersByProductTime_.end() && it->first.first == product && it->first.second <= to; ++it) {
+        window.append(it->first.second, bucketStats(*it));
+    }
+    window.finish();
+    return window.query(from, to);
+}
+
+std::vector<PyramidRow> OrderBook::getChartRows(const std::string& product, const std::string& from,
+                                                const std::string& to, std::size_t maxRows) const {
+    Lock lock(mutex_);
+    std::int64_t lo = std::numeric_limits<std::int64_t>::min(), hi = std::numeric_limits<std::int64_t>::max();
+    if ((!from.empty() && !TimeKey::parseTimestamp(from, lo)) || (!to.empty() && !TimeKey::parseTimestamp(to, hi))) {
+        std::cerr << "Could not parse chart window: " << from << " .. " << to << std::endl;
+        return {};
+    }
+    if (rangeStatsCurrent_) {
+        auto it = pyramids_.find(product);
+        return (it == pyramids_.end()) ? std::vector<PyramidRow>() : it->second.rows(lo, hi, maxRows);
+    }
+    // Stale pyramids: rebuild this product's (whole, so edge buckets match the precomputed answer).
+    ProductPyramid pyramid;
+    for (auto it = ordersByProductTime_.lower_bound({product, std::string()});
+         it != ordersByProductTime_.end() && it->first.first == product; ++it) {
+        pyramid.append(it->first.second, bucketStats(*it));
+    }
+    pyramid.finish();
+    return pyramid.rows(lo, hi, maxRows);
+}
+
+// -------- Stop orders (see StopOrderIndex.h, docs/orderbook-matching.md) --------
+// Stops live outside ordersByProductTime_ until triggered; then they become normal orders.
+
+int OrderBook::addStopOrder(StopKind kind, double triggerPrice, const OrderBookEntry& order) {
+    Lock lock(mutex_);
+    return stops_.addStop(kind, triggerPrice, order);
+}
+
+bool OrderBook::cancelStopOrder(int id) {
+    Lock lock(mutex_);
+    return stops_.cancelStop(id);
+}
+
+std::vector<OrderBookEntry> OrderBook::onPriceUpdate(const std::string& product, double price, const std::string& timestamp) {
+    Lock lock(mutex_);
+    std::vector<OrderBookEntry> activated = stops_.onPrice(product, price, timestamp);
+    for (const OrderBookEntry& order : activated) {
+        insertOrder(order);
+    }
+    return activated;
 }
@@ -7,20 +7,99 @@
  *
  * DOCS (embedded references):
  *   docs/orderbook-matching.md — How matching uses getOrders(type, product, timestamp).
- *   docs/trading-market-basics.md — Best bid/ask, spread; getBestBid/getBestAsk.
- *   docs/orderbook-time.md — getEarliestTime, getNextTime, getPreviousTime.
+ *   docs/trading-market-basics.md — Best bid/ask, spread; getBestBid/getBestAsk; tick-grid ladder.
+ *   docs/orderbook-time.md — getEarliestTime, getNextTime, getPreviousTime (B+tree / frozen Eytzinger time axis).
+ *   docs/orderbook-matching.md — Stop orders: addStopOrder, onPriceUpdate.
+ *   docs/orderbook-statistics.md — getWindowStats: O(1) window stats from RangeStats.
+ *   docs/orderbook-statistics.md — getChartRows: 1s … 1h pre-aggregated pyramid (TimePyramid).
+ *   docs/orderbook-statistics.md — getSummary / getTimeSummary: precomputed per-bucket summary rows.
+ *   docs/trading-market-basics.md — getTicker: seqlock top of book for reader threads.
+ *   docs/orderbook-time.md — Time travel: enableHistory, getBookAt, cancelOrder, fillOrder.
+ *   docs/orderbook-time.md — asOfJoin: book state at or before each event, by linear merge.
  *
- * USE: Include "OrderBook.h" and "OrderBookEntry.h"; link OrderBook.cpp. Build with -Isrc.
+ *   docs/orderbook-loading.md — loadAsync: background load, progress, what is visible while loading.
+ *   docs/orderbook-retention.md — setRetention / evictBefore: bounded memory for live ingestion.
+ *   docs/orderbook-retention.md — setMemoryBudget: LRU page-out of cold partitions, paged back in on access.
+ *   docs/orderbook-retention.md — setMemoryBudget with no spill file: cold partitions compressed in memory.
+ *   docs/orderbook-loading.md — exportOrders: parallel CSV / binary export of a filtered subset.
+ *   docs/orderbook-matching.md — query / countMatching: OrderQuery predicates over column batches.
+ *   docs/orderbook-matching.md — simulateExecutions: TWAP / VWAP parent orders against the history.
+ *   docs/orderbook-statistics.md — groupBy: parallel group-by reports (per-thread hash tables).
+ *   docs/orderbook-statistics.md — topOrders: K largest orders (per-thread bounded heaps).
+ *   docs/trading-market-basics.md — buildHeatmap: price × time volume grid, filled in parallel tiles.
+ *
+ * THREADS: every public method takes mutex_, so a loadAsync thread can fill the book while the menu
+ * thread queries it. Recursive because public methods call each other (e.g. onPriceUpdate → insertOrder).
+ *
+ * USE: Include "OrderBook.h" and "OrderBookEntry.h"; link OrderBook.cpp. Build with -Isrc -pthread.
  */
 
 #pragma once
 
 #include "OrderBookEntry.h"
+#include "AsOfJoin.h"
+#include "ExecutionSimulator.h"
+#include "BPlusTree.h"
+#include "BookHistory.h"
+#include "CompressedColumns.h"
 #include "CSVReader.h"
+#include "EytzingerIndex.h"
+#include "GroupBy.h"
+#include "Heatmap.h"
+#include "TopOrders.h"
+#include "OrderQuery.h"
+#include "PriceLevelIndex.h"
+#include "RangeStats.h"
+#include "TimePyramid.h"
+#include "StopOrderIndex.h"
+#include "SummaryTable.h"
+#include "TopOfBookTicker.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
+/** Snapshot of a background load (OrderBook::getLoadProgress). */
+struct LoadProgress {
+    std::uint64_t bytesRead{0};
+    std::uint64_t totalBytes{0};
+    std::size_t entries{0};  /** orders in the book so far (queryable) */
+    bool loading{false};
+
+    /** Share of the file parsed, 0–100. */
+    double percent() const {
+        if (totalBytes == 0) return loading ? 0.0 : 100.0;
+        return 100.0 * static_cast<double>(bytesRead) / static_cast<double>(totalBytes);
+    }
+};
+
+/** Live-mode retention (OrderBook::setRetention). A zero limit means "no limit"; the newest
+    timestamp is never evicted. */
+struct RetentionPolicy {
+    std::size_t maxTimestamps{0};  /** keep only the newest N timestamps */
+    std::int64_t maxAgeMicros{0};  /** keep only timestamps within this many µs of the newest (e.g. 60 * TimeKey::second) */
+    std::string spillPath;         /** append evicted partitions to this file (BinaryIO blocks); empty = discard */
+};
+
+/** Which orders OrderBook::exportOrders writes. Empty strings mean "no limit". */
+struct ExportFilter {
+    std::string product;  /** one product; empty = every product */
+    std::string from;     /** first timestamp, inclusive */
+    std::string to;       /** last timestamp, inclusive */
+    bool bids{true};
+    bool asks{true};
+};
+
+/** csv = the input format (reloadable with load); binary = BinaryIO partition blocks. */
+enum class ExportFormat { csv, binary };
+
 class OrderBook {
 public:
     /** Empty order book; call load(filename) to load from CSV. */
@@ -29,9 +108,26 @@ public:
     /** Load order book from CSV file (e.g. data/order_book_example.csv). */
     explicit OrderBook(const std::string& filename);
 
-    /** (Re)load from CSV; clears current book and fills from file. */
+    /** Stops a running loadAsync (if any) and waits for its thread. */
+    ~OrderBook();
+
+    /** (Re)load from CSV. The file is parsed into a staging book first and swapped in at the end, so
+        queries during the reload keep answering from the previous data. */
     void load(const std::string& filename);
 
+    /** Clear the book and load filename on a background thread; returns immediately. Orders are
+        committed one timestamp at a time, so earlier timestamps are queryable while later ones load. */
+    void loadAsync(const std::string& filename);
+
+    /** Bytes parsed, orders committed, and whether a loadAsync is still running. Lock-free. */
+    LoadProgress getLoadProgress() const;
+
+    /** True while a loadAsync thread is running. */
+    bool isLoading() const { return loading_.load(); }
+
+    /** Block until a running loadAsync has finished (no-op otherwise). */
+    void waitForLoad();
+
     /** Unique product names (trading pairs) in the book. */
     std::vector<std::string> getKnownProducts() const;
 
@@ -41,30 +137,339 @@ public:
     /** Append one order to the book. */
     void insertOrder(const OrderBookEntry& order);
 
+    /** Remove the first order in order's bucket with the same type, price and amount. atTime stamps the
+        change in the history (empty = order.timestamp). Returns false if no such order. */
+    bool cancelOrder(const OrderBookEntry& order, const std::string& atTime = "");
+
+    /** Take amount off that order (removing it once nothing is left); same lookup as cancelOrder. */
+    bool fillOrder(const OrderBookEntry& order, double amount, const std::string& atTime = "");
+
+    /** Start recording level history with a full checkpoint every checkpointEvery timestamps. Replays
+        the current book into it; load() re-records while enabled. */
+    void enableHistory(std::size_t checkpointEvery = 64);
+
+    /** Levels and best prices of product as they were at time (after every insert/cancel/fill stamped
+        <= time). O(K) replay from the nearest checkpoint. Empty snapshot if history is not enabled. */
+    BookSnapshot getBookAt(const std::string& product, const std::string& time) const;
+
     /** All entries for the given product and timestamp (both bids and asks). Input for a matching engine. */
     std::vector<OrderBookEntry> matchOrders(const std::string& product, const std::string& timestamp) const;
 
+    /** Put product on a fixed tick grid (level i = basePrice + i * tickSize). Its best bid/ask at the
+        product's latest timestamp then come from a bitmap ladder in O(1) instead of a B+tree lookup;
+        earlier timestamps keep using the depth levels. The latest bucket is indexed immediately.
+        Memory: two dense ladders (bid, ask) of about 12 bytes per level each, so ~24 * levelCount
+        bytes per product (24 MB for a million levels), held for the latest timestamp only. */
+    void setTickGrid(const std::string& product, double basePrice, double tickSize, std::size_t levelCount);
+
     /** Best bid: highest bid price for this product and timestamp. Returns 0.0 if no bids. */
     double getBestBid(const std::string& product, const std::string& timestamp) const;
 
     /** Best ask: lowest ask price for this product and timestamp. Returns 0.0 if no asks. */
     double getBestAsk(const std::string& product, const std::string& timestamp) const;
 
+    /** Aggregated levels for one side, best first (bids high→low, asks low→high), at most maxLevels. */
+    std::vector<PriceLevel> getDepth(OrderBookType type, const std::string& product, const std::string& timestamp,
+                                     std::size_t maxLevels) const;
+
+    /** Seqlock top of book for product's latest timestamp, kept current by load/insertOrder. Call on the
+        book thread before starting readers; the pointer stays valid for the book's lifetime, and readers
+        may then poll ticker->read() from any thread. */
+    const TopOfBookTicker* getTicker(const std::string& product);
+
     /** All entries (flat vector) for stats e.g. computeAveragePrice(getAllEntries()). */
     std::vector<OrderBookEntry> getAllEntries() const;
 
     /** All entries at the given timestamp (any product). For current-time-window stats. */
     std::vector<OrderBookEntry> getAllEntriesAtTime(const std::string& timestamp) const;
 
-    /** Earliest / latest timestamp in the book. Empty string if no entries. */
+    /** Earliest / latest timestamp in the book. Empty string if no entries. O(log n) via the time axis. */
     std::string getEarliestTime() const;
     std::string getLatestTime() const;
     /** Next / previous timestamp in sorted order. Empty string if none. */
     std::string getNextTime(const std::string& currentTime) const;
     std::string getPreviousTime(const std::string& currentTime) const;
 
+    /** All timestamps t with from <= t <= to, ascending. Bounds for time-range queries. */
+    std::vector<std::string> getTimesBetween(const std::string& from, const std::string& to) const;
+
+    /** Bound memory for live ingestion: whenever the book holds more than the policy allows, the oldest
+        timestamps are evicted in bulk (after each insertOrder and load). Applies immediately. */
+    void setRetention(const RetentionPolicy& policy);
+
+    /** Evict every partition with timestamp < cutoff, all products: one range erase per product and
+        index, spilled to the policy's spillPath if set. Returns the number of orders evicted. */
+    std::size_t evictBefore(const std::string& cutoff);
+
+    /** Keep the estimated bytes of in-memory orders under budgetBytes: least-recently-used (product,
+        timestamp) partitions are written to spillFile (created/truncated) and dropped from memory, and
+        paged back in transparently when getOrders, getAllEntriesAtTime, etc. touch them.
+        An empty spillFile keeps paged-out partitions in memory instead, compressed column by column
+        (CompressedColumns): less memory than resident, no disk I/O, but slower to scan than resident;
+        window stats over them are computed without decoding to entries.
+        0 = unlimited (pages everything back in). Returns false if spillFile cannot be opened. */
+    bool setMemoryBudget(std::size_t budgetBytes, const std::string& spillFile);
+
+    /** Estimated bytes of order buckets in memory (only tracked while a memory budget is set). */
+    std::size_t getResidentBytes() const;
+
+    /** Partitions currently paged out (to the spill file, or compressed in memory). */
+    std::size_t getPagedOutPartitions() const;
+
+    /** Heap bytes of the compressed partitions (0 unless paging to memory: empty spillFile). */
+    std::size_t getCompressedBytes() const;
+
+    /** Write the orders matching filter to path, in time order (then product), formatted in parallel by
+        `threads` workers (0 = hardware_concurrency) into per-thread buffers and written with large
+        positional writes. Holds the book lock for the whole export. Returns the number of orders
+        written; 0 (logged) if path cannot be written. */
+    std::size_t exportOrders(const std::string& path, const ExportFilter& filter,
+                             ExportFormat format = ExportFormat::csv, unsigned threads = 0) const;
+
+    /** Orders passing every predicate of q, in (product, timestamp) order. Buckets outside q's product
+        and time range are skipped unread; the rest are scanned in column batches by OrderQuery::select. */
+    std::vector<OrderBookEntry> query(const OrderQuery& q) const;
+
+    /** Number of orders query(q) would return, without copying them. */
+    std::size_t countMatching(const OrderQuery& q) const;
+
+    /** Aggregate the orders passing filter into groups keyed as spec says (product, time bucket, side),
+        with `threads` workers (0 = hardware_concurrency), each into its own hash table, merged at the
+        end. Rows are sorted by product, time, side. Holds the book lock throughout. */
+    std::vector<GroupRow> groupBy(const GroupBySpec& spec, const OrderQuery& filter = OrderQuery(),
+                                  unsigned threads = 0) const;
+
+    /** The spec.k largest orders matching filter (by amount or notional; K in all or K per product),
+        largest first. Bounded heap per worker thread (0 = hardware_concurrency), merged at the end. */
+    std::vector<OrderBookEntry> topOrders(const TopOrdersSpec& spec, const OrderQuery& filter = OrderQuery(),
+                                          unsigned threads = 0) const;
+
+    /** Price × time grid of spec.product's resting bid / ask volume (see Heatmap.h), filled by `threads`
+        workers (0 = hardware_concurrency), one tile of columns each. Empty grid if the product has no
+        orders in the window. */
+    Heatmap buildHeatmap(const HeatmapSpec& spec, unsigned threads = 0) const;
+
+    /** Snapshot the time axis into a read-only Eytzinger array for the fastest next/previous lookups.
+        load() does this automatically; insertOrder at a new timestamp thaws it until called again. */
+    void freezeTimeAxis();
+
+    /** High/low/average price, volume, notional for product over all timestamps in [from, to].
+        O(log n) from precomputed tables, which insertOrder keeps current when it adds at the product's
+        latest timestamp or a later one. Stale tables (insert into the past, cancel, fill, eviction)
+        make it scan the window instead. */
+    WindowStats getWindowStats(const std::string& product, const std::string& from, const std::string& to) const;
+
+    /** Chart rows for product over [from, to] (empty = unbounded): the finest pyramid level (1s, 10s, 1m,
+        10m, 1h) that fits in maxRows rows, else 1h. Precomputed and kept current with the window tables; if
+        they are stale, the product's pyramid is rebuilt for this call. */
+    std::vector<PyramidRow> getChartRows(const std::string& product, const std::string& from, const std::string& to,
+                                         std::size_t maxRows) const;
+
+    /** Precomputed summary of (product, timestamp): count, bid/ask volume, min/max/sum price, best bid/ask.
+        count == 0 if the bucket is empty. Kept current by insertOrder / cancelOrder / fillOrder. */
+    SummaryRow getSummary(const std::string& product, const std::string& timestamp) const;
+
+    /** Summary rows of every product at timestamp (product order). */
+    std::vector<SummaryRow> getSummariesAtTime(const std::string& timestamp) const;
+
+    /** All products at timestamp folded into one row (what getAllEntriesAtTime + compute* would give). */
+    SummaryRow getTimeSummary(const std::string& timestamp) const;
+
+    /** For each event, its product's book state (best bid/ask, volume and count per side) at the latest
+        timestamp <= the event's: one linear merge of the events with the summary rows. Quotes are in
+        event order; events need not be sorted (sorted ones skip a sort). */
+    std::vector<AsOfQuote> asOfJoin(const std::vector<AsOfEvent>& events) const;
+
+    /** Same for a plain stream of timestamps of one product. */
+    std::vector<AsOfQuote> asOfJoin(const std::string& product, const std::vector<std::string>& timestamps) const;
+
+    /** Work each parent order as a TWAP / VWAP schedule of child orders filled against the depth at their
+        timestamps (see ExecutionSimulator.h). The depth the parents need is copied under the lock; the
+        simulations then run on `threads` workers (0 = hardware_concurrency) without it. */
+    std::vector<ExecutionReport> simulateExecutions(const std::vector<ParentOrder>& parents, unsigned threads = 0) const;
+
+    /** Number of orders in the book, from a maintained counter (no copy, no lock; unlike getAllEntries().size()). */
+    std::size_t getEntryCount() const { return entryCount_.load(); }
+
+    /** Rebuild the per-product window tables and chart pyramids (load() does this; call after inserts
+        into past timestamps, cancels, fills or eviction, which leave them stale). */
+    void buildRangeStats();
+
+    /** Park a stop-loss / stop-limit order until the price crosses triggerPrice. Returns its id. */
+    int addStopOrder(StopKind kind, double triggerPrice, const OrderBookEntry& order);
+
+    /** Cancel a parked stop. Returns false if it already fired or the id is unknown. */
+    bool cancelStopOrder(int id);
+
+    /** Last trade / best price for product changed: insert every stop it triggers and return them. */
+    std::vector<OrderBookEntry> onPriceUpdate(const std::string& product, double price, const std::string& timestamp);
+
 private:
     using ProductTime = std::pair<std::string, std::string>;
-    /** Orders grouped by (product, timestamp) for O(log n) lookup. */
-    std::map<ProductTime, std::vector<OrderBookEntry>> ordersByProductTime_;
+    using Lock = std::lock_guard<std::recursive_mutex>;
+    using Buckets = std::map<ProductTime, std::vector<OrderBookEntry>>;
+
+    /** Guards everything below except the atomics. */
+    mutable std::recursive_mutex mutex_;
+
+    /** Empty every index (caller holds mutex_). */
+    void resetBook();
+    /** Fill this (private, unshared) book from filename: readCSV, group, index, finishLoad. */
+    void buildFrom(const std::string& filename);
+    /** Exchange all order data and indexes with other (not tickers, grids, stops, or history settings). */
+    void swapIndexes(OrderBook& other);
+    /** Post-load indexes: frozen time axis, window tables, tickers (caller holds mutex_). */
+    void finishLoad();
+    /** loadAsync thread body: parse line by line, commit each timestamp's batch under the lock. */
+    void loadWorker(const std::string& filename);
+    /** Ask a running loader to stop and join it. */
+    void stopLoader();
+
+    std::thread loader_;
+    std::atomic<bool> loading_{false};
+    std::atomic<bool> stopLoading_{false};
+    std::atomic<std::uint64_t> bytesRead_{0};
+    std::atomic<std::uint64_t> totalBytes_{0};
+    std::atomic<std::size_t> entryCount_{0};
+
+    /** Orders grouped by (product, timestamp) for O(log n) lookup. mutable: under a memory budget,
+        const readers page buckets back in (see pageIn). */
+    mutable Buckets ordersByProductTime_;
+
+    /** Price levels of one (product, timestamp): key = orderable bits of the price, value = total amount. */
+    struct DepthLevels {
+        BPlusTree<double> bids;
+        BPlusTree<double> asks;
+    };
+
+    /** Add e to the time axis and to its bucket's depth levels (called by load and insertOrder). */
+    void indexOrder(const OrderBookEntry& e);
+
+    /** Sorted time axis: µs since epoch → timestamp string as stored in ordersByProductTime_. */
+    BPlusTree<std::string> timeAxis_;
+    /** Timestamps the axis could not key (unparsable or differently formatted duplicates). While > 0
+        the time helpers fall back to the slow getAllEntries() scan so results stay exact. */
+    std::size_t unkeyedTimes_{0};
+    /** Frozen copy of the time axis: Eytzinger search over keys, answers index into frozenTimes_. */
+    EytzingerIndex frozenTimeIndex_;
+    std::vector<std::string> frozenTimes_;
+    bool timeAxisFrozen_{false};
+    std::map<ProductTime, DepthLevels> depthByProductTime_;
+
+    /** One row per bucket, sorted by (timestamp, product). */
+    SummaryTable summaries_;
+
+    /** Per-product window tables; only used while rangeStatsCurrent_ (cleared by inserts into the past,
+        cancel/fill and eviction; appends at the latest timestamp update them in place). */
+    std::map<std::string, ProductRangeStats> rangeStats_;
+    /** Per-product chart pyramids; built and invalidated together with rangeStats_. */
+    std::map<std::string, ProductPyramid> pyramids_;
+    bool rangeStatsCurrent_{false};
+
+    /** Tick grid registered with setTickGrid. */
+    struct TickGrid {
+        double basePrice;
+        double tickSize;
+        std::size_t levelCount;
+    };
+    /** Bid and ask ladders for a product's latest timestamp. offGrid: an order missed the grid, so scan instead. */
+    struct GridLevels {
+        PriceLevelIndex bids;
+        PriceLevelIndex asks;
+        bool offGrid{false};
+    };
+
+    /** Bucket for (product, timestamp) or nullptr; lets readers scan in place instead of copying. */
+    const std::vector<OrderBookEntry>* findBucket(const std::string& product, const std::string& timestamp) const;
+
+    /** Add e to its ladder if e.product is on a tick grid. */
+    void indexLevel(const OrderBookEntry& e);
+    /** Create the ladder for bucket key from every order already in the bucket. */
+    void buildLadder(const ProductTime& key, const TickGrid& g);
+
+    std::map<std::string, TickGrid> tickGrids_;
+    /** At most one entry per product: its latest bucket (see indexLevel). */
+    std::map<ProductTime, GridLevels> levelsByProductTime_;
+    /** Writer-side state for one product's ticker: which timestamp it shows and what was last published. */
+    struct TickerState {
+        std::string timestamp;
+        TopOfBook top;
+        std::unique_ptr<TopOfBookTicker> ticker{std::make_unique<TopOfBookTicker>()};
+    };
+
+    /** Best price and total size at that price on each side of one bucket (first depth level per side). */
+    TopOfBook computeTopOfBook(const std::string& product, const std::string& timestamp) const;
+
+    /** Update product's ticker after order was added: incremental if same timestamp, rescan if newer. */
+    void publishTop(const OrderBookEntry& order);
+
+    /** Point state at product's latest timestamp, rescan, and publish. */
+    void republishTop(const std::string& product, TickerState& state);
+
+    /** Republish every product's latest timestamp (after load). */
+    void publishAllTops();
+
+    /** One entry per product; never erased so readers' pointers stay valid across load(). */
+    std::map<std::string, TickerState> tickers_;
+    /** Stops waiting for their trigger; not part of the book until they fire. */
+    StopOrderIndex stops_;
+
+    /** Take amount off the matching order in every index (full removal if amount covers it). */
+    bool reduceOrder(const OrderBookEntry& order, double amount, const std::string& atTime);
+
+    /** Replay ordersByProductTime_ (time-sorted per product) into history_ as inserts. */
+    void recordHistory();
+
+    /** Evict down to retention_ (no-op without limits). */
+    void enforceRetention();
+    RetentionPolicy retention_;
+
+    /** Paging state of one bucket while a memory budget is set. */
+    struct Page {
+        std::int64_t offset{-1};  /** block in the page file; -1 = never written */
+        std::size_t bytes{0};     /** bucketBytes while resident */
+        bool resident{false};     /** false until pageChanged first measures it */
+        bool dirty{true};         /** changed since it was last written */
+        bool pinned{false};       /** resident and out of lru_ until unpinPages (see pinPage) */
+        std::list<ProductTime>::iterator lru;  /** position in lru_ while resident */
+        CompressedColumns cold;   /** the orders while paged out, when paging to memory */
+    };
+
+    /** bucket's orders, reading them back from the page file first if they were paged out. Marks the
+        bucket most recently used. Every read of a bucket's orders goes through here. */
+    const std::vector<OrderBookEntry>& pageIn(Buckets::value_type& bucket) const;
+    /** pageIn, then keep bucket resident until unpinPages: it leaves lru_, so later page-ins cannot page
+        it out. For rounds that page in several buckets and read them all afterwards. */
+    const std::vector<OrderBookEntry>& pinPage(Buckets::value_type& bucket) const;
+    /** Put the pinned buckets back at the recent end of lru_ and enforce the budget again. */
+    void unpinPages() const;
+    /** bucket was modified: re-measure, mark dirty and most recently used. */
+    void pageChanged(Buckets::value_type& bucket);
+    /** Forget the page of a bucket that is being erased. */
+    void dropPage(const ProductTime& key);
+    /** Run q over its buckets; append the matches to out if not null. Returns the match count. */
+    std::size_t runQuery(const OrderQuery& q, std::vector<OrderBookEntry>* out) const;
+    /** Buckets inside q's product and time range, in map order (not paged in). */
+    std::vector<Buckets::iterator> queryBuckets(const OrderQuery& q) const;
+    /** Summary of a bucket's orders: straight from the compressed columns if it is paged out to memory,
+        else from its (paged-in) orders. */
+    BucketStats bucketStats(Buckets::value_type& bucket) const;
+    /** Page out least-recently-used buckets until residentBytes_ <= memoryBudget_. */
+    void enforceBudget() const;
+    /** Start paging afresh for the current buckets (after load / loadAsync reset). */
+    void resetPaging();
+    /** Estimated heap bytes of a bucket's orders. */
+    static std::size_t bucketBytes(const std::vector<OrderBookEntry>& entries);
+
+    std::size_t memoryBudget_{0};  /** 0 = no budget, no paging */
+    std::string pageFilePath_;     /** empty = page out to compressed memory, not to a file */
+    mutable std::fstream pageFile_;
+    mutable std::map<ProductTime, Page> pages_;
+    mutable std::list<ProductTime> lru_;  /** resident buckets, least recently used first */
+    mutable std::vector<ProductTime> pinned_;  /** resident buckets held out of lru_ by pinPage */
+    mutable std::size_t residentBytes_{0};
+    mutable std::size_t compressedBytes_{0};
+
+    /** Checkpoint + delta history; null until enableHistory. */
+    std::unique_ptr<BookHistory> history_;
 };
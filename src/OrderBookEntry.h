@@ -58,6 +58,13 @@ public:
     void print() const;
 };
 
+// -------- PriceLevel: one aggregated level of a book side --------
+/** Total amount resting at one price (depth views, book snapshots). */
+struct PriceLevel {
+    double price{0.0};
+    double amount{0.0};
+};
+
 // -------- Global vector of orders (loaded via CSVReader::readCSV) --------
 extern std::vector<OrderBookEntry> orders;
 
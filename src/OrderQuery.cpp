@@ -0,0 +1,191 @@
+/*
+ * OrderQuery.cpp — predicate folding and the selection-vector kernels (see OrderQuery.h).
+ *
+ * PURPOSE: where() narrows a per-column interval; select() chains a dense kernel and refine kernels
+ * over the constrained columns.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-matching.md — Queries.
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc. The AVX2 kernel is picked at run time
+ * (BitOps::hasAvx2), so no -mavx2 is needed.
+ */
+
+#include "OrderQuery.h"
+#include "BitOps.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+    const double kInf = std::numeric_limits<double>::infinity();
+
+    // -------- Kernels: sel gets the index of every passing row; the count advances by the test --------
+
+#if BITOPS_AVX2
+    /** Per 4-bit pass mask, the pshufb control that moves the passing lanes' 32-bit indices to the front. */
+    struct Compact {
+        alignas(16) std::uint8_t bytes[16][16];
+        int count[16];
+        Compact() {
+            for (int mask = 0; mask < 16; ++mask) {
+                int out = 0;
+                for (int lane = 0; lane < 4; ++lane) {
+                    if (!(mask & (1 << lane))) continue;
+                    for (int b = 0; b < 4; ++b) bytes[mask][out * 4 + b] = static_cast<std::uint8_t>(lane * 4 + b);
+                    ++out;
+                }
+                count[mask] = out;
+                for (int b = out * 4; b < 16; ++b) bytes[mask][b] = 0x80;
+            }
+        }
+    };
+
+    /** selectRange over rows [0, n rounded down to 4), four doubles per compare; i = first row not tested.
+        Writing all 4 lanes is safe: k <= i, so sel + k + 3 < n while i + 4 <= n. */
+    BITOPS_TARGET_AVX2 std::size_t selectRangeAvx2(const double* x, std::size_t n, double low, double high,
+                                                   std::uint32_t* sel, std::size_t& i) {
+        static const Compact compact;
+        std::size_t k = 0;
+        const __m256d lo = _mm256_set1_pd(low), hi = _mm256_set1_pd(high);
+        __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+        const __m128i step = _mm_set1_epi32(4);
+        for (i = 0; i + 4 <= n; i += 4) {
+            const __m256d v = _mm256_loadu_pd(x + i);
+            const __m256d pass = _mm256_and_pd(_mm256_cmp_pd(v, lo, _CMP_GE_OQ), _mm256_cmp_pd(v, hi, _CMP_LE_OQ));
+            const int mask = _mm256_movemask_pd(pass);
+            const __m128i control = _mm_load_si128(reinterpret_cast<const __m128i*>(compact.bytes[mask]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(sel + k), _mm_shuffle_epi8(index, control));
+            k += static_cast<std::size_t>(compact.count[mask]);
+            index = _mm_add_epi32(index, step);
+        }
+        return k;
+    }
+#endif
+
+    std::size_t selectRange(const double* x, std::size_t n, double low, double high, std::uint32_t* sel) {
+        std::size_t k = 0, i = 0;
+#if BITOPS_AVX2
+        if (BitOps::hasAvx2()) k = selectRangeAvx2(x, n, low, high, sel, i);
+#endif
+        for (; i < n; ++i) {
+            sel[k] = static_cast<std::uint32_t>(i);
+            k += (x[i] >= low) & (x[i] <= high);
+        }
+        return k;
+    }
+
+    std::size_t refineRange(const double* x, std::uint32_t* sel, std::size_t k, double low, double high) {
+        std::size_t out = 0;
+        for (std::size_t j = 0; j < k; ++j) {
+            const std::uint32_t i = sel[j];
+            sel[out] = i;  // in place: out <= j
+            out += (x[i] >= low) & (x[i] <= high);
+        }
+        return out;
+    }
+
+    std::size_t selectSide(const std::uint8_t* side, std::size_t n, std::uint8_t want, std::uint32_t* sel) {
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            sel[k] = static_cast<std::uint32_t>(i);
+            k += (side[i] == want);
+        }
+        return k;
+    }
+
+    std::size_t refineSide(const std::uint8_t* side, std::uint32_t* sel, std::size_t k, std::uint8_t want) {
+        std::size_t out = 0;
+        for (std::size_t j = 0; j < k; ++j) {
+            const std::uint32_t i = sel[j];
+            sel[out] = i;
+            out += (side[i] == want);
+        }
+        return out;
+    }
+}
+
+// -------- Building: fold each comparison into its column's interval --------
+
+OrderQuery& OrderQuery::product(const std::string& name) {
+    product_ = name;
+    return *this;
+}
+
+OrderQuery& OrderQuery::between(const std::string& from, const std::string& to) {
+    from_ = from;
+    to_ = to;
+    if (!from_.empty() && !to_.empty() && to_ < from_) empty_ = true;
+    return *this;
+}
+
+OrderQuery& OrderQuery::side(OrderBookType type) {
+    const int want = static_cast<int>(type);
+    if (side_ >= 0 && side_ != want) empty_ = true;
+    side_ = want;
+    return *this;
+}
+
+OrderQuery& OrderQuery::where(OrderColumn column, CompareOp op, double value) {
+    Range& r = range(column);
+    r.used = true;
+    if (std::isnan(value)) {  // every comparison with NaN is false
+        empty_ = true;
+        return *this;
+    }
+    switch (op) {
+        case CompareOp::lt: r.high = std::min(r.high, std::nextafter(value, -kInf)); break;
+        case CompareOp::le: r.high = std::min(r.high, value); break;
+        case CompareOp::eq: r.low = std::max(r.low, value); r.high = std::min(r.high, value); break;
+        case CompareOp::ge: r.low = std::max(r.low, value); break;
+        case CompareOp::gt: r.low = std::max(r.low, std::nextafter(value, kInf)); break;
+    }
+    if (r.low > r.high) empty_ = true;
+    return *this;
+}
+
+// -------- Running --------
+
+std::size_t OrderQuery::select(const OrderColumns& cols, std::uint32_t* sel) const {
+    if (empty_) return 0;
+    // Numeric columns first: their dense kernel is the vectorized one. The side byte only refines.
+    std::size_t k = 0;
+    bool first = true;
+    const std::pair<const Range*, const double*> columns[] = {{&price_, cols.price}, {&amount_, cols.amount}};
+    for (const auto& c : columns) {
+        if (!c.first->used) continue;
+        k = first ? selectRange(c.second, cols.rows, c.first->low, c.first->high, sel)
+                  : refineRange(c.second, sel, k, c.first->low, c.first->high);
+        first = false;
+    }
+    if (side_ >= 0) {
+        const std::uint8_t want = static_cast<std::uint8_t>(side_);
+        k = first ? selectSide(cols.side, cols.rows, want, sel) : refineSide(cols.side, sel, k, want);
+        first = false;
+    }
+    if (first) {  // no row predicates: every row
+        for (std::size_t i = 0; i < cols.rows; ++i) sel[i] = static_cast<std::uint32_t>(i);
+        k = cols.rows;
+    }
+    return k;
+}
+
+std::size_t OrderQuery::selectEntries(const OrderBookEntry* rows, std::size_t n, OrderBatch& batch) const {
+    if (price_.used) for (std::size_t i = 0; i < n; ++i) batch.price[i] = rows[i].price;
+    if (amount_.used) for (std::size_t i = 0; i < n; ++i) batch.amount[i] = rows[i].amount;
+    if (side_ >= 0) for (std::size_t i = 0; i < n; ++i) batch.side[i] = static_cast<std::uint8_t>(rows[i].orderType);
+    OrderColumns cols;
+    cols.price = batch.price.data();
+    cols.amount = batch.amount.data();
+    cols.side = batch.side.data();
+    cols.rows = n;
+    return select(cols, batch.sel.data());
+}
+
+bool OrderQuery::matches(const OrderBookEntry& e) const {
+    if (empty_) return false;
+    if (side_ >= 0 && static_cast<int>(e.orderType) != side_) return false;
+    if (price_.used && !(e.price >= price_.low && e.price <= price_.high)) return false;
+    if (amount_.used && !(e.amount >= amount_.low && e.amount <= amount_.high)) return false;
+    return true;
+}
@@ -0,0 +1,116 @@
+/*
+ * OrderQuery.h — composable order filters compiled to selection-vector kernels.
+ *
+ * PURPOSE: getOrders answers one fixed question (side, product, timestamp). Anything richer — "ETH/BTC
+ * bids above X with amount > Y between t0 and t1" — meant a hand-written loop over a getAllEntries
+ * copy. An OrderQuery states the question once and runs it at scan speed over any columnar run of
+ * orders: OrderBook::query / countMatching, or a ColumnarView partition (ExternalSort.h) as is.
+ *
+ * DESIGN:
+ *   - Two levels. product and time range are partition predicates: OrderBook prunes whole (product,
+ *     timestamp) buckets with them and never reads their rows. side, price and amount are row
+ *     predicates, evaluated by select().
+ *   - Compile as you build: every where() on a column folds into one closed interval [low, high] for
+ *     that column (x > v becomes x >= nextafter(v, +inf), exact for doubles), so any AND of
+ *     comparisons costs one range test per column. A contradiction (e.g. price > 5 and price < 3)
+ *     marks the query as matching nothing before any data is touched.
+ *   - select() runs one kernel per constrained column. The first writes a selection vector (indices of
+ *     passing rows) from the dense column; each later one only tests the rows still selected. Kernels
+ *     are branch-free (store the index, advance by the test result); on CPUs with AVX2 (checked at run
+ *     time, no -mavx2 needed) the dense price/amount kernel compares four doubles at once and compacts
+ *     their indices with one shuffle.
+ *   - Tradeoff: AND only. An OR of queries is several queries (results are in book order, so they
+ *     merge cheaply).
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-matching.md — Queries: OrderQuery and OrderBook::query.
+ *
+ * USE: Include "OrderQuery.h"; link OrderQuery.cpp. Build with -Isrc.
+ */
+
+#pragma once
+
+#include "OrderBookEntry.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+enum class OrderColumn { price, amount };
+
+enum class CompareOp { lt, le, eq, ge, gt };
+
+/** A run of orders, one array per field. A column the query does not constrain may be null. */
+struct OrderColumns {
+    const double* price{nullptr};
+    const double* amount{nullptr};
+    const std::uint8_t* side{nullptr};  /** 0 = bid, 1 = ask (the OrderBookType values, as in ColumnarView) */
+    std::size_t rows{0};
+};
+
+/** Per-thread scratch for OrderQuery::selectEntries: column copies of up to kRows orders and the
+    selection vector. */
+struct OrderBatch {
+    static constexpr std::size_t kRows = 1024;
+    std::vector<double> price = std::vector<double>(kRows);
+    std::vector<double> amount = std::vector<double>(kRows);
+    std::vector<std::uint8_t> side = std::vector<std::uint8_t>(kRows);
+    std::vector<std::uint32_t> sel = std::vector<std::uint32_t>(kRows);
+};
+
+class OrderQuery {
+public:
+    /** Only this product (partition predicate). */
+    OrderQuery& product(const std::string& name);
+
+    /** Only timestamps in [from, to], inclusive; an empty string means no limit (partition predicate). */
+    OrderQuery& between(const std::string& from, const std::string& to);
+
+    /** Only bids or only asks. */
+    OrderQuery& side(OrderBookType type);
+
+    /** AND column op value. NaN values never pass (as with the plain comparison). */
+    OrderQuery& where(OrderColumn column, CompareOp op, double value);
+
+    const std::string& getProduct() const { return product_; }  /** empty = every product */
+    const std::string& getFrom() const { return from_; }
+    const std::string& getTo() const { return to_; }
+
+    /** True if the predicates contradict each other (no order can pass). */
+    bool matchesNothing() const { return empty_; }
+
+    /** Whether select() reads the column (callers filling OrderColumns can skip the others). */
+    bool reads(OrderColumn column) const { return range(column).used; }
+    bool readsSide() const { return side_ >= 0; }
+
+    /** Write the indices of the rows of cols that pass every row predicate, ascending, to sel (room for
+        cols.rows indices). Returns how many passed. */
+    std::size_t select(const OrderColumns& cols, std::uint32_t* sel) const;
+
+    /** select() over rows[0 .. n), n <= OrderBatch::kRows, stored as entries: copies only the columns
+        the query reads into batch, then leaves the passing indices in batch.sel. */
+    std::size_t selectEntries(const OrderBookEntry* rows, std::size_t n, OrderBatch& batch) const;
+
+    /** The row predicates on one order (the scalar reference of select()). */
+    bool matches(const OrderBookEntry& e) const;
+
+private:
+    /** Compiled form of every where() on one column: low <= x <= high. */
+    struct Range {
+        double low{-std::numeric_limits<double>::infinity()};
+        double high{std::numeric_limits<double>::infinity()};
+        bool used{false};
+    };
+
+    Range& range(OrderColumn column) { return column == OrderColumn::price ? price_ : amount_; }
+    const Range& range(OrderColumn column) const { return column == OrderColumn::price ? price_ : amount_; }
+
+    std::string product_;
+    std::string from_;
+    std::string to_;
+    int side_{-1};  /** -1 = both sides */
+    Range price_;
+    Range amount_;
+    bool empty_{false};
+};
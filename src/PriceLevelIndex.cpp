@@ -0,0 +1,133 @@
+/*
+ * PriceLevelIndex.cpp — implementation of the tick-grid ladder and its three-level bitmap.
+ *
+ * PURPOSE: add/remove update the level's volume and order count and keep the bitmap in sync
+ * (set bits bottom-up when a level fills, clear them bottom-up when a word becomes zero).
+ * lowestLevel/highestLevel walk top_ → mid_ → leaf_ with one find-first-set per level.
+ *
+ * DOCS (embedded references):
+ *   docs/trading-market-basics.md — Best bid = highest level, best ask = lowest level.
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc.
+ */
+
+#include "PriceLevelIndex.h"
+#include <cmath>
+
+// -------- Constructor: size the volume array and all three bitmap levels --------
+
+PriceLevelIndex::PriceLevelIndex(double basePrice, double tickSize, std::size_t levelCount)
+    : basePrice_(basePrice), tickSize_(tickSize), levelCount_(levelCount),
+      volume_(levelCount, 0.0), orders_(levelCount, 0),
+      leaf_((levelCount + 63) / 64, 0),
+      mid_((leaf_.size() + 63) / 64, 0),
+      top_((mid_.size() + 63) / 64, 0) {}
+
+// -------- Grid mapping --------
+// (price - base) / tick must be a whole number (within rounding) inside [0, levelCount).
+
+std::size_t PriceLevelIndex::levelOf(double price) const {
+    if (tickSize_ <= 0.0) return npos;
+    const double offset = (price - basePrice_) / tickSize_;
+    const double rounded = std::round(offset);
+    if (rounded < 0.0 || rounded >= static_cast<double>(levelCount_)) return npos;
+    if (std::fabs(offset - rounded) > 1e-6) return npos;
+    return static_cast<std::size_t>(rounded);
+}
+
+bool PriceLevelIndex::onGrid(double price) const {
+    return levelOf(price) != npos;
+}
+
+// -------- add / remove / reduce --------
+
+bool PriceLevelIndex::add(double price, double amount) {
+    const std::size_t level = levelOf(price);
+    if (level == npos) return false;
+    if (orders_[level]++ == 0) setBit(level);
+    volume_[level] += amount;
+    return true;
+}
+
+bool PriceLevelIndex::remove(double price, double amount) {
+    const std::size_t level = levelOf(price);
+    if (level == npos || orders_[level] == 0) return false;
+    if (--orders_[level] == 0) {
+        volume_[level] = 0.0;  // drop rounding residue along with the last order
+        clearBit(level);
+    } else {
+        volume_[level] -= amount;
+    }
+    return true;
+}
+
+bool PriceLevelIndex::reduce(double price, double amount) {
+    const std::size_t level = levelOf(price);
+    if (level == npos || orders_[level] == 0) return false;
+    volume_[level] -= amount;
+    return true;
+}
+
+// -------- Bitmap maintenance --------
+// Setting: mark the leaf bit, then the parent bits (cheap; idempotent).
+// Clearing: clear the leaf bit; only clear a parent bit once the child word became zero.
+
+void PriceLevelIndex::setBit(std::size_t level) {
+    const std::size_t leafWord = level / 64;
+    const std::size_t midWord = leafWord / 64;
+    leaf_[leafWord] |= std::uint64_t{1} << (level % 64);
+    mid_[midWord] |= std::uint64_t{1} << (leafWord % 64);
+    top_[midWord / 64] |= std::uint64_t{1} << (midWord % 64);
+}
+
+void PriceLevelIndex::clearBit(std::size_t level) {
+    const std::size_t leafWord = level / 64;
+    const std::size_t midWord = leafWord / 64;
+    leaf_[leafWord] &= ~(std::uint64_t{1} << (level % 64));
+    if (leaf_[leafWord] != 0) return;
+    mid_[midWord] &= ~(std::uint64_t{1} << (leafWord % 64));
+    if (mid_[midWord] != 0) return;
+    top_[midWord / 64] &= ~(std::uint64_t{1} << (midWord % 64));
+}
+
+// -------- Lookups: one find-first-set per bitmap level --------
+// top_ usually has a single word (≤ 262144 levels); longer ladders scan a handful of top words.
+
+std::size_t PriceLevelIndex::lowestLevel() const {
+    for (std::size_t t = 0; t < top_.size(); ++t) {
+        if (top_[t] == 0) continue;
+        const std::size_t midWord = t * 64 + BitOps::lowestSetBit(top_[t]);
+        const std::size_t leafWord = midWord * 64 + BitOps::lowestSetBit(mid_[midWord]);
+        return leafWord * 64 + BitOps::lowestSetBit(leaf_[leafWord]);
+    }
+    return npos;
+}
+
+std::size_t PriceLevelIndex::highestLevel() const {
+    for (std::size_t t = top_.size(); t-- > 0;) {
+        if (top_[t] == 0) continue;
+        const std::size_t midWord = t * 64 + BitOps::highestSetBit(top_[t]);
+        const std::size_t leafWord = midWord * 64 + BitOps::highestSetBit(mid_[midWord]);
+        return leafWord * 64 + BitOps::highestSetBit(leaf_[leafWord]);
+    }
+    return npos;
+}
+
+bool PriceLevelIndex::empty() const {
+    return lowestLevel() == npos;
+}
+
+double PriceLevelIndex::highestPrice() const {
+    const std::size_t level = highestLevel();
+    return (level == npos) ? 0.0 : priceOf(level);
+}
+
+double PriceLevelIndex::lowestPrice() const {
+    const std::size_t level = lowestLevel();
+    return (level == npos) ? 0.0 : priceOf(level);
+}
+
+double PriceLevelIndex::volumeAt(double price) const {
+    const std::size_t level = levelOf(price);
+    return (level == npos) ? 0.0 : volume_[level];
+}
@@ -0,0 +1,79 @@
+/*
+ * PriceLevelIndex.h — array-indexed price ladder with a hierarchical bitmap of non-empty levels.
+ *
+ * PURPOSE: For products that trade on a fixed tick grid, price level i is (basePrice + i * tickSize).
+ * Volume lives in a plain array indexed by level, and a three-level bitmap records which levels are
+ * non-empty. Best bid (highest non-empty level) and best ask (lowest non-empty level) are then a few
+ * find-first-set instructions instead of a scan over every order.
+ *
+ * DESIGN: leaf_ has one bit per level; mid_ has one bit per non-zero leaf_ word; top_ has one bit
+ * per non-zero mid_ word. One top_ word covers 64 * 64 * 64 = 262144 levels, so for realistic grids
+ * a lookup touches one word at each level: constant time no matter how deep the book is.
+ * Tradeoff: memory is dense (one volume + one count slot per level), so pick levelCount to cover the
+ * product's realistic price range, not every possible price. Prices off the grid are rejected
+ * (add returns false) and the caller falls back to scanning.
+ *
+ * DOCS (embedded references):
+ *   docs/trading-market-basics.md — Best bid/ask; how OrderBook uses the ladder (setTickGrid).
+ *
+ * USE: Include "PriceLevelIndex.h"; link PriceLevelIndex.cpp. OrderBook keeps one per side for the
+ * latest timestamp of each product registered with setTickGrid. Build with -Isrc.
+ */
+
+#pragma once
+
+#include "BitOps.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class PriceLevelIndex {
+public:
+    /** Ladder of levelCount levels: basePrice, basePrice + tickSize, ... */
+    PriceLevelIndex(double basePrice, double tickSize, std::size_t levelCount);
+
+    /** True if price falls exactly (within rounding) on a level of this ladder. */
+    bool onGrid(double price) const;
+
+    /** Add one order of amount at price. Returns false (and changes nothing) if price is off the grid. */
+    bool add(double price, double amount);
+
+    /** Remove one order of amount at price. Returns false if off the grid or the level is already empty. */
+    bool remove(double price, double amount);
+
+    /** Take amount off the level at price without removing an order (partial fill). False if off the grid or empty. */
+    bool reduce(double price, double amount);
+
+    /** True if no level holds an order. */
+    bool empty() const;
+
+    /** Price of the highest non-empty level (best bid). 0.0 if empty. */
+    double highestPrice() const;
+
+    /** Price of the lowest non-empty level (best ask). 0.0 if empty. */
+    double lowestPrice() const;
+
+    /** Total amount resting at price; 0.0 if empty or off the grid. */
+    double volumeAt(double price) const;
+
+private:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /** Level for price, or npos if off the grid. */
+    std::size_t levelOf(double price) const;
+    double priceOf(std::size_t level) const { return basePrice_ + static_cast<double>(level) * tickSize_; }
+
+    void setBit(std::size_t level);
+    void clearBit(std::size_t level);
+    std::size_t lowestLevel() const;
+    std::size_t highestLevel() const;
+
+    double basePrice_;
+    double tickSize_;
+    std::size_t levelCount_;
+    std::vector<double> volume_;         /** amount per level */
+    std::vector<std::uint32_t> orders_;  /** order count per level; a level is non-empty while > 0 */
+    std::vector<std::uint64_t> leaf_;    /** bit per level */
+    std::vector<std::uint64_t> mid_;     /** bit per non-zero leaf_ word */
+    std::vector<std::uint64_t> top_;     /** bit per non-zero mid_ word */
+};
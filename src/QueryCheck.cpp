@@ -0,0 +1,372 @@
+/*
+ * QueryCheck.cpp — scratch driver: runs OrderBook's bulk queries with and without a memory budget and
+ * compares the answers.
+ *
+ * PURPOSE: The bulk queries (groupBy, ...) read buckets in rounds that page in several buckets before
+ * any is read, so a paging mistake loses rows silently. A budget changes where the orders live, never
+ * what the queries return: every check here runs the same query on an unbudgeted book, a book paged
+ * to compressed memory and a book paged to a file, and reports any difference.
+ *
+ * DESIGN:
+ *   - Books: data/order_book_example.csv, and a generated "small then big" book (a 1-order bucket,
+ *     then a 600-order bucket larger than the whole budget), the case that used to drop rows.
+ *   - One check function per query; each prints one PASS / FAIL line. Exit code = number of failures.
+ *   - checkLiveStats: window stats and chart rows kept current by inserts at the latest timestamp must
+ *     equal a rebuild (buildRangeStats) exactly.
+ *   - checkHistory: getBookAt(product, t) must equal getDepth(product, t) at every loaded t, since each
+ *     CSV timestamp is a full book. checkHistoryCancels: a later cancel carries the book forward minus
+ *     the order; a cancel stamped in the past changes only its own time's book.
+ *   - checkLadderAfterCancel: best bid/ask from a tick-grid ladder rebuilt after the latest bucket empties.
+ *   - Not a unit-test framework: plain asserts would stop at the first difference, and the point is
+ *     to see every query that disagrees.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-retention.md — Memory budget; checking paged queries (QueryCheck).
+ *
+ * BUILD: scripts/build-QueryCheck.ps1, or from repo root:
+ *   g++ -std=c++17 -O2 -pthread -Isrc -o build/QueryCheck src/QueryCheck.cpp <the library sources of
+ *   scripts/build-MerkelMain.ps1 except src/MerkelMain.cpp>
+ * Run from repo root (reads data/; scratch files go to a querycheck directory under the system temp
+ * directory, removed again before exit).
+ */
+
+#include "OrderBook.h"
+#include "TimeKey.h"
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+    int failures = 0;
+
+    /** Per-run scratch directory under the system temp directory; main() creates and removes it. */
+    const std::filesystem::path scratchDir =
+        std::filesystem::temp_directory_path() / "querycheck";
+
+    std::string scratch(const std::string& file) { return (scratchDir / file).string(); }
+
+    void report(const std::string& what, bool ok, const std::string& detail = "") {
+        std::cout << (ok ? "PASS " : "FAIL ") << what << (detail.empty() ? "" : " — " + detail) << std::endl;
+        if (!ok) ++failures;
+    }
+
+    bool near(double a, double b) {
+        return a == b || std::fabs(a - b) <= 1e-9 * std::max(1.0, std::max(std::fabs(a), std::fabs(b)));
+    }
+
+    /** A 1-order bucket, then one bucket of 600 orders: bigger than the whole 20 000-byte budget. */
+    std::string writeSmallThenBig() {
+        const std::string path = scratch("smallbig.csv");
+        std::ofstream out(path, std::ios::trunc);
+        out << "2020/03/17 17:01:24.000000,ETH/BTC,bid,5,0.02\n";
+        for (int i = 1; i <= 600; ++i) {
+            out << "2020/03/17 17:01:25.000000,ETH/BTC,ask,0." << (i < 10 ? "00" : i < 100 ? "0" : "") << i << ",0.03\n";
+        }
+        return path;
+    }
+
+    /** The three ways to hold the same book: all resident, paged to compressed memory, paged to a file. */
+    struct Books {
+        OrderBook plain;
+        OrderBook compressed;
+        OrderBook paged;
+
+        explicit Books(const std::string& csv, std::size_t budget = 20000)
+            : plain(csv), compressed(csv), paged(csv) {
+            compressed.setMemoryBudget(budget, "");
+            paged.setMemoryBudget(budget, scratch("pages.bin"));
+        }
+    };
+
+    // -------- Checks: one per query, each against the unbudgeted book --------
+
+    bool sameRows(const std::vector<GroupRow>& a, const std::vector<GroupRow>& b) {
+        if (a.size() != b.size()) return false;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if (a[i].product != b[i].product || a[i].time != b[i].time || a[i].side != b[i].side ||
+                a[i].count != b[i].count || a[i].priceMin != b[i].priceMin || a[i].priceMax != b[i].priceMax ||
+                !near(a[i].amountSum, b[i].amountSum) || !near(a[i].notional, b[i].notional)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void checkGroupBy(const std::string& name, Books& books) {
+        GroupBySpec spec;
+        spec.bySide = true;
+        spec.timeBucket = TimeKey::second;
+        const std::vector<GroupRow> want = books.plain.groupBy(spec, OrderQuery(), 2);
+        std::size_t count = 0;
+        for (const GroupRow& row : want) count += row.count;
+        report(name + ": groupBy covers every order", count == books.plain.getEntryCount(),
+               std::to_string(count) + " of " + std::to_string(books.plain.getEntryCount()));
+        report(name + ": groupBy, compressed budget", sameRows(want, books.compressed.groupBy(spec, OrderQuery(), 2)));
+        report(name + ": groupBy, page file", sameRows(want, books.paged.groupBy(spec, OrderQuery(), 2)));
+    }
+
+    bool sameOrders(const std::vector<OrderBookEntry>& a, const std::vector<OrderBookEntry>& b) {
+        if (a.size() != b.size()) return false;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if (a[i].price != b[i].price || a[i].amount != b[i].amount || a[i].timestamp != b[i].timestamp ||
+                a[i].product != b[i].product || a[i].orderType != b[i].orderType) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void checkTopOrders(const std::string& name, Books& books) {
+        TopOrdersSpec spec;
+        spec.k = 5;
+        const std::vector<OrderBookEntry> want = books.plain.topOrders(spec, OrderQuery(), 2);
+        report(name + ": topOrders, compressed budget", sameOrders(want, books.compressed.topOrders(spec, OrderQuery(), 2)));
+        report(name + ": topOrders, page file", sameOrders(want, books.paged.topOrders(spec, OrderQuery(), 2)));
+        spec.perProduct = true;
+        spec.rank = TopOrderRank::notional;
+        const std::vector<OrderBookEntry> perProduct = books.plain.topOrders(spec, OrderQuery(), 2);
+        report(name + ": topOrders per product by notional, compressed budget",
+               sameOrders(perProduct, books.compressed.topOrders(spec, OrderQuery(), 2)));
+    }
+
+    bool sameGrid(const Heatmap& a, const Heatmap& b) {
+        if (a.columnCount() != b.columnCount() || a.priceBins() != b.priceBins()) return false;
+        for (std::size_t c = 0; c < a.columnCount(); ++c) {
+            if (a.snapshots(c) != b.snapshots(c)) return false;
+            for (std::size_t bin = 0; bin < a.priceBins(); ++bin) {
+                if (!near(a.bidVolume(c, bin), b.bidVolume(c, bin)) || !near(a.askVolume(c, bin), b.askVolume(c, bin))) return false;
+            }
+        }
+        return true;
+    }
+
+    void checkHeatmap(const std::string& name, Books& books) {
+        HeatmapSpec spec;
+        spec.product = "ETH/BTC";
+        spec.priceBins = 16;
+        const Heatmap want = books.plain.buildHeatmap(spec, 2);
+        double volume = 0.0;
+        for (std::size_t c = 0; c < want.columnCount(); ++c) {
+            for (std::size_t bin = 0; bin < want.priceBins(); ++bin) volume += want.bidVolume(c, bin) + want.askVolume(c, bin);
+        }
+        report(name + ": buildHeatmap has volume", want.columnCount() > 0 && volume > 0.0);
+        report(name + ": buildHeatmap, compressed budget", sameGrid(want, books.compressed.buildHeatmap(spec, 2)));
+        report(name + ": buildHeatmap, page file", sameGrid(want, books.paged.buildHeatmap(spec, 2)));
+    }
+
+    std::string readFile(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    void checkExport(const std::string& name, Books& books) {
+        for (ExportFormat format : {ExportFormat::csv, ExportFormat::binary}) {
+            const std::string kind = (format == ExportFormat::csv) ? "csv" : "binary";
+            const std::size_t want = books.plain.exportOrders(scratch("plain.out"), ExportFilter(), format, 2);
+            report(name + ": exportOrders " + kind + " writes every order", want == books.plain.getEntryCount(),
+                   std::to_string(want) + " of " + std::to_string(books.plain.getEntryCount()));
+            const std::string plain = readFile(scratch("plain.out"));
+            const std::size_t compressed = books.compressed.exportOrders(scratch("budget.out"), ExportFilter(), format, 2);
+            report(name + ": exportOrders " + kind + ", compressed budget",
+                   compressed == want && readFile(scratch("budget.out")) == plain);
+            const std::size_t paged = books.paged.exportOrders(scratch("budget.out"), ExportFilter(), format, 2);
+            report(name + ": exportOrders " + kind + ", page file", paged == want && readFile(scratch("budget.out")) == plain);
+        }
+    }
+
+    bool sameLevels(const std::vector<PriceLevel>& a, const std::vector<PriceLevel>& b) {
+        if (a.size() != b.size()) return false;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if (!near(a[i].price, b[i].price) || !near(a[i].amount, b[i].amount)) return false;
+        }
+        return true;
+    }
+
+    /** Each CSV timestamp is a full book, so the history at a loaded t must be exactly that bucket's depth. */
+    void checkHistory(const std::string& name, Books& books) {
+        OrderBook& book = books.plain;
+        book.enableHistory(4);
+        std::size_t checked = 0;
+        std::string first;
+        for (const std::string& product : book.getKnownProducts()) {
+            for (std::string t = book.getEarliestTime(); !t.empty(); t = book.getNextTime(t)) {
+                const BookSnapshot snapshot = book.getBookAt(product, t);
+                const std::vector<PriceLevel> bids = book.getDepth(OrderBookType::bid, product, t, SIZE_MAX);
+                const std::vector<PriceLevel> asks = book.getDepth(OrderBookType::ask, product, t, SIZE_MAX);
+                if (!bids.empty() || !asks.empty()) {
+                    ++checked;
+                    if (first.empty() && (!sameLevels(snapshot.bids, bids) || !sameLevels(snapshot.asks, asks))) {
+                        first = product + " at " + t + ": " + std::to_string(snapshot.bids.size()) + " bid levels, depth has " +
+                                std::to_string(bids.size());
+                    }
+                }
+                if (book.getNextTime(t) <= t) break;  // the time axis wraps to the start
+            }
+        }
+        report(name + ": getBookAt equals getDepth at every loaded timestamp", checked > 0 && first.empty(),
+               first.empty() ? std::to_string(checked) + " (product, time) books" : first);
+    }
+
+    /** levels with amount taken off price (the level dropped once empty); levels is best-first. */
+    std::vector<PriceLevel> without(std::vector<PriceLevel> levels, double price, double amount) {
+        for (auto it = levels.begin(); it != levels.end(); ++it) {
+            if (it->price != price) continue;
+            it->amount -= amount;
+            if (it->amount <= 1e-12) levels.erase(it);
+            break;
+        }
+        return levels;
+    }
+
+    /** Cancels are deltas, not snapshots: cancelling an order of the latest bucket at a later time
+        leaves the book minus that order at the later time, and the earlier book as it was. A cancel
+        stamped before the latest timestamp (no atTime) changes its own bucket's book, not the latest. */
+    void checkHistoryCancels(const std::string& name, const std::string& csv) {
+        OrderBook book(csv);
+        book.enableHistory(4);
+        const std::string latest = book.getLatestTime();
+        const std::string later = latest.substr(0, latest.size() - 1) + (latest.back() == '9' ? "8" : "9");
+        std::size_t checked = 0;
+        std::string first;
+        for (const std::string& product : book.getKnownProducts()) {
+            const std::vector<OrderBookEntry> bids = book.getOrders(OrderBookType::bid, product, latest);
+            if (bids.empty()) continue;
+            const OrderBookEntry& order = bids.front();
+            const BookSnapshot before = book.getBookAt(product, latest);
+            book.cancelOrder(order, later);
+            const BookSnapshot at = book.getBookAt(product, later);
+            const BookSnapshot still = book.getBookAt(product, latest);
+            ++checked;
+            if (first.empty() && (!sameLevels(at.bids, without(before.bids, order.price, order.amount)) ||
+                                  !sameLevels(at.asks, before.asks) || !sameLevels(still.bids, before.bids) ||
+                                  !sameLevels(still.asks, before.asks))) {
+                first = product + ": " + std::to_string(at.bids.size()) + " bid levels after the cancel, " +
+                        std::to_string(before.bids.size()) + " before";
+            }
+        }
+        report(name + ": getBookAt after a later cancel is the earlier book minus the order", checked > 0 && first.empty(),
+               first.empty() ? std::to_string(checked) + " cancels" : first);
+
+        OrderBook small;
+        small.enableHistory(1);
+        const std::string t1 = "2020/03/17 17:01:24.000000", t3 = "2020/03/17 17:01:26.000000";
+        const OrderBookEntry old(100, 1, t1, "ETH/BTC", OrderBookType::bid);
+        small.insertOrder(old);
+        small.insertOrder(OrderBookEntry(100, 5, t3, "ETH/BTC", OrderBookType::bid));
+        small.cancelOrder(old);
+        const BookSnapshot atT1 = small.getBookAt("ETH/BTC", t1);
+        const BookSnapshot atT3 = small.getBookAt("ETH/BTC", t3);
+        const std::vector<PriceLevel> depthT3 = small.getDepth(OrderBookType::bid, "ETH/BTC", t3, SIZE_MAX);
+        report(name + ": a cancel stamped before the latest time changes its own time only",
+               atT1.bids.empty() && sameLevels(atT3.bids, depthT3) && depthT3.size() == 1,
+               std::to_string(atT1.bids.size()) + " bid levels at t1, t3 best bid amount " +
+                   (atT3.bids.empty() ? std::string("none") : std::to_string(atT3.bids.front().amount)));
+    }
+
+    /** A cancel that empties the latest bucket drops its ladder; the next insert into the now-latest
+        older bucket must build a ladder from that whole bucket, not from the one new order. */
+    void checkLadderAfterCancel(const std::string& name) {
+        OrderBook book;
+        book.setTickGrid("ETH/BTC", 0, 1, 1000);
+        const std::string t1 = "2020/03/17 17:01:24.000000", t2 = "2020/03/17 17:01:25.000000";
+        book.insertOrder(OrderBookEntry(100, 1, t1, "ETH/BTC", OrderBookType::bid));
+        book.insertOrder(OrderBookEntry(110, 1, t1, "ETH/BTC", OrderBookType::ask));
+        const OrderBookEntry later(105, 1, t2, "ETH/BTC", OrderBookType::bid);
+        book.insertOrder(later);
+        book.cancelOrder(later);
+        book.insertOrder(OrderBookEntry(90, 1, t1, "ETH/BTC", OrderBookType::bid));
+        const double bid = book.getBestBid("ETH/BTC", t1), ask = book.getBestAsk("ETH/BTC", t1);
+        report(name + ": ladder rebuilt from the whole bucket after the latest bucket empties", bid == 100 && ask == 110,
+               "best bid " + std::to_string(bid) + ", best ask " + std::to_string(ask));
+    }
+
+    bool sameWindow(const WindowStats& a, const WindowStats& b) {
+        return a.count == b.count && a.low == b.low && a.high == b.high && a.averagePrice == b.averagePrice &&
+               a.volume == b.volume && a.notional == b.notional;
+    }
+
+    bool sameChart(const std::vector<PyramidRow>& a, const std::vector<PyramidRow>& b) {
+        if (a.size() != b.size()) return false;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            const BucketStats& x = a[i].stats;
+            const BucketStats& y = b[i].stats;
+            if (a[i].start != b[i].start || a[i].width != b[i].width || x.count != y.count || x.low != y.low ||
+                x.high != y.high || x.priceSum != y.priceSum || x.volume != y.volume || x.notional != y.notional) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Live inserts at the latest timestamp (and at new later ones) update the window tables and chart
+        pyramids in place; they must equal a rebuild exactly, at every window. */
+    void checkLiveStats(const std::string& name, const std::string& csv) {
+        OrderBook live(csv), rebuilt(csv);
+        const std::vector<std::string> products = live.getKnownProducts();
+        const std::string latest = live.getLatestTime();
+        const std::string later = latest.substr(0, latest.size() - 1) + (latest.back() == '9' ? "8" : "9");
+        for (int i = 0; i < 200; ++i) {
+            const std::string& product = products[i % products.size()];
+            const std::string& t = (i < 100) ? latest : later;
+            const OrderBookEntry order(0.5 + 0.001 * i, 1.0 + 0.01 * i, t, product,
+                                       (i % 2) ? OrderBookType::ask : OrderBookType::bid);
+            live.insertOrder(order);
+            rebuilt.insertOrder(order);
+        }
+        rebuilt.buildRangeStats();
+        std::vector<std::string> times;
+        for (std::string t = live.getEarliestTime(); !t.empty(); t = live.getNextTime(t)) {
+            times.push_back(t);
+            if (live.getNextTime(t) <= t) break;
+        }
+        std::size_t compared = 0, bad = 0;
+        for (const std::string& product : products) {
+            for (std::size_t from = 0; from < times.size(); ++from) {
+                for (std::size_t to = from; to < times.size(); ++to) {
+                    ++compared;
+                    if (!sameWindow(live.getWindowStats(product, times[from], times[to]),
+                                    rebuilt.getWindowStats(product, times[from], times[to]))) ++bad;
+                }
+            }
+            for (std::size_t rows : {1, 4, 64, 100000}) {
+                ++compared;
+                if (!sameChart(live.getChartRows(product, "", "", rows), rebuilt.getChartRows(product, "", "", rows))) ++bad;
+            }
+        }
+        report(name + ": window stats and chart rows after live inserts equal a rebuild", compared > 0 && bad == 0,
+               std::to_string(bad) + " of " + std::to_string(compared) + " answers differ");
+    }
+
+    void checkAll(const std::string& name, Books& books) {
+        checkGroupBy(name, books);
+        checkTopOrders(name, books);
+        checkHeatmap(name, books);
+        checkExport(name, books);
+        checkHistory(name, books);
+    }
+}
+
+int main() {
+    std::filesystem::create_directories(scratchDir);
+    {
+        Books example("data/order_book_example.csv");
+        checkAll("example", example);
+    }
+    checkLiveStats("example", "data/order_book_example.csv");
+    checkHistoryCancels("example", "data/order_book_example.csv");
+    checkLadderAfterCancel("tick grid");
+    {
+        Books smallBig(writeSmallThenBig());
+        checkAll("small-then-big", smallBig);
+    }
+    std::error_code ignored;
+    std::filesystem::remove_all(scratchDir, ignored);
+    std::cout << (failures ? std::to_string(failures) + " check(s) failed." : std::string("All checks passed.")) << std::endl;
+    return failures;
+}
@@ -0,0 +1,130 @@
+/*
+ * RangeStats.cpp — prefix sums and sparse tables behind ProductRangeStats (see RangeStats.h).
+ *
+ * PURPOSE: append() summarises one timestamp; finish() builds the min/max sparse tables level by
+ * level; addOrder() updates the tail for live inserts; query() turns [from, to] into an index range
+ * and combines O(1) lookups.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-statistics.md — Window stats.
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc.
+ */
+
+#include "RangeStats.h"
+#include "BitOps.h"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+// -------- append: one timestamp → one row of summaries --------
+
+void ProductRangeStats::append(const std::string& timestamp, const std::vector<OrderBookEntry>& entries) {
+    BucketStats stats;
+    for (const OrderBookEntry& e : entries) stats.add(e.price, e.amount);
+    append(timestamp, stats);
+}
+
+void ProductRangeStats::append(const std::string& timestamp, const BucketStats& stats) {
+    times_.push_back(timestamp);
+    last_ = stats;
+    low_.push_back(stats.low);
+    high_.push_back(stats.high);
+    countPrefix_.push_back(countPrefix_.back() + stats.count);
+    pricePrefix_.push_back(pricePrefix_.back() + stats.priceSum);
+    volumePrefix_.push_back(volumePrefix_.back() + stats.volume);
+    notionalPrefix_.push_back(notionalPrefix_.back() + stats.notional);
+}
+
+// -------- finish: sparse tables, level j built from level j-1 --------
+
+void ProductRangeStats::finish() {
+    const std::size_t n = times_.size();
+    minTable_.assign(1, low_);
+    maxTable_.assign(1, high_);
+    for (std::size_t width = 2; width <= n; width *= 2) {
+        const std::vector<double>& prevMin = minTable_.back();
+        const std::vector<double>& prevMax = maxTable_.back();
+        const std::size_t half = width / 2;
+        std::vector<double> mins(n - width + 1), maxs(n - width + 1);
+        for (std::size_t i = 0; i + width <= n; ++i) {
+            mins[i] = std::min(prevMin[i], prevMin[i + half]);
+            maxs[i] = std::max(prevMax[i], prevMax[i + half]);
+        }
+        minTable_.push_back(std::move(mins));
+        maxTable_.push_back(std::move(maxs));
+    }
+}
+
+// -------- addOrder: only the last timestamp's row and the blocks ending at it change --------
+// Level j's entry i covers [i, i + 2^j); the one that reaches the last index n - 1 is i = n - 2^j.
+
+bool ProductRangeStats::addOrder(const std::string& timestamp, double price, double amount) {
+    const bool grow = times_.empty() || times_.back() < timestamp;
+    if (!grow && times_.back() != timestamp) return false;
+    if (grow) {
+        times_.push_back(timestamp);
+        last_ = BucketStats();
+        low_.push_back(0.0);
+        high_.push_back(0.0);
+        countPrefix_.push_back(0);
+        pricePrefix_.push_back(0.0);
+        volumePrefix_.push_back(0.0);
+        notionalPrefix_.push_back(0.0);
+    }
+    last_.add(price, amount);
+    refreshLast();
+    return true;
+}
+
+void ProductRangeStats::refreshLast() {
+    const std::size_t n = times_.size();
+    low_[n - 1] = last_.low;
+    high_[n - 1] = last_.high;
+    countPrefix_[n] = countPrefix_[n - 1] + last_.count;
+    pricePrefix_[n] = pricePrefix_[n - 1] + last_.priceSum;
+    volumePrefix_[n] = volumePrefix_[n - 1] + last_.volume;
+    notionalPrefix_[n] = notionalPrefix_[n - 1] + last_.notional;
+
+    for (std::size_t level = 0, width = 1; width <= n; ++level, width *= 2) {
+        if (level == minTable_.size()) {  // n just reached 2^level: a new level with one block
+            minTable_.emplace_back();
+            maxTable_.emplace_back();
+        }
+        const std::size_t i = n - width;
+        double low = low_[n - 1], high = high_[n - 1];
+        if (level > 0) {
+            const std::size_t half = width / 2;
+            low = std::min(minTable_[level - 1][i], minTable_[level - 1][i + half]);
+            high = std::max(maxTable_[level - 1][i], maxTable_[level - 1][i + half]);
+        }
+        if (i == minTable_[level].size()) {  // the last timestamp is new: its blocks are new too
+            minTable_[level].push_back(low);
+            maxTable_[level].push_back(high);
+        } else {
+            minTable_[level][i] = low;
+            maxTable_[level][i] = high;
+        }
+    }
+}
+
+// -------- query: [from, to] → [l, r) → O(1) combine --------
+// Timestamp strings sort chronologically (fixed-width CSV format), so binary search on them is valid.
+
+WindowStats ProductRangeStats::query(const std::string& from, const std::string& to) const {
+    WindowStats stats;
+    const std::size_t l = std::lower_bound(times_.begin(), times_.end(), from) - times_.begin();
+    const std::size_t r = std::upper_bound(times_.begin(), times_.end(), to) - times_.begin();
+    if (l >= r || minTable_.empty()) return stats;
+    stats.count = countPrefix_[r] - countPrefix_[l];
+    if (stats.count == 0) return stats;
+
+    const int level = BitOps::highestSetBit(static_cast<std::uint64_t>(r - l));  // floor(log2(width))
+    const std::size_t span = std::size_t{1} << level;
+    stats.low = std::min(minTable_[level][l], minTable_[level][r - span]);
+    stats.high = std::max(maxTable_[level][l], maxTable_[level][r - span]);
+    stats.averagePrice = (pricePrefix_[r] - pricePrefix_[l]) / static_cast<double>(stats.count);
+    stats.volume = volumePrefix_[r] - volumePrefix_[l];
+    stats.notional = notionalPrefix_[r] - notionalPrefix_[l];
+    return stats;
+}
@@ -0,0 +1,118 @@
+/*
+ * RangeStats.h — precomputed per-product window statistics: O(1) high/low/average/volume for any time range.
+ *
+ * PURPOSE: computeHighPrice / computeLowPrice / computeAveragePrice rescan every entry they are given,
+ * so a dashboard asking thousands of ad-hoc windows over the same history rescans it thousands of times.
+ * ProductRangeStats summarises each timestamp once, then answers any window [from, to] with two binary
+ * searches (to find the window's ends) plus O(1) arithmetic.
+ *
+ * DESIGN:
+ *   - Per timestamp i we keep min/max price, entry count, sum of prices, volume, and notional.
+ *   - Sums → prefix arrays: sum over [l, r) = prefix[r] - prefix[l]. O(1).
+ *   - Min/max are not subtractable, so they go in sparse tables: table[j][i] = min of the 2^j
+ *     timestamps starting at i. Any window is covered by two overlapping power-of-two blocks, so
+ *     min(table[j][l], table[j][r - 2^j]) answers in O(1).
+ *   - WHY prefix arrays and not a Fenwick tree? Live inserts land at the product's latest timestamp,
+ *     and a change to the last timestamp only touches the tail: prefix[n] and one sparse-table entry
+ *     per level (the block ending at n). addOrder updates those in O(log n) and queries stay O(1); a
+ *     Fenwick tree would make every query O(log n) to support updates in the middle, which only
+ *     inserts into past timestamps need. Those return false and OrderBook rebuilds instead.
+ *   - Tradeoff: sparse tables use O(n log n) memory per product (two doubles per timestamp per level).
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-statistics.md — Window stats; relation to computeAveragePrice etc.
+ *
+ * USE: Include "RangeStats.h"; link RangeStats.cpp. OrderBook builds one per product after load
+ * (buildRangeStats) and answers getWindowStats(product, from, to). Build with -Isrc.
+ */
+
+#pragma once
+
+#include "OrderBookEntry.h"
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+/** Stats over every entry of one product in a time window. All zero if the window is empty. */
+struct WindowStats {
+    std::size_t count{0};
+    double low{0.0};           /** computeLowPrice over the window */
+    double high{0.0};          /** computeHighPrice over the window */
+    double averagePrice{0.0};  /** computeAveragePrice over the window (unweighted mean) */
+    double volume{0.0};        /** sum of amount */
+    double notional{0.0};      /** sum of price * amount */
+
+    /** Volume-weighted average price; 0.0 if there is no volume. */
+    double vwap() const { return (volume > 0.0) ? notional / volume : 0.0; }
+};
+
+/** One timestamp's summary, the input of ProductRangeStats::append. Producers that never build
+    OrderBookEntry values (e.g. CompressedColumns::stats) fill it directly. */
+struct BucketStats {
+    std::size_t count{0};
+    double low{std::numeric_limits<double>::infinity()};
+    double high{-std::numeric_limits<double>::infinity()};
+    double priceSum{0.0};
+    double volume{0.0};
+    double notional{0.0};
+
+    /** Fold in one order (sums in call order, so the same rows give the same doubles). */
+    void add(double price, double amount) {
+        low = std::min(low, price);
+        high = std::max(high, price);
+        priceSum += price;
+        volume += amount;
+        notional += price * amount;
+        ++count;
+    }
+
+    /** Fold in another summary (e.g. the next timestamp of a coarser bucket). */
+    void merge(const BucketStats& other) {
+        low = std::min(low, other.low);
+        high = std::max(high, other.high);
+        priceSum += other.priceSum;
+        volume += other.volume;
+        notional += other.notional;
+        count += other.count;
+    }
+};
+
+class ProductRangeStats {
+public:
+    /** Add the next timestamp's entries. Timestamps must arrive in ascending order. */
+    void append(const std::string& timestamp, const std::vector<OrderBookEntry>& entries);
+
+    /** Same, from a precomputed summary of the timestamp's entries. */
+    void append(const std::string& timestamp, const BucketStats& stats);
+
+    /** Build the sparse tables; call once after the last append. */
+    void finish();
+
+    /** One more order at timestamp, after finish(): folded into the latest timestamp, or appended as a
+        new latest one, in O(log n). Tables equal a rebuild bit for bit (the last timestamp's sums are
+        redone in row order). Returns false, changing nothing, if timestamp is older than the latest. */
+    bool addOrder(const std::string& timestamp, double price, double amount);
+
+    /** Stats for all timestamps t with from <= t <= to. */
+    WindowStats query(const std::string& from, const std::string& to) const;
+
+private:
+    /** Recompute the tail: low_/high_/prefix of the last timestamp from last_, and the table entries
+        covering it (appended when the last timestamp is new). */
+    void refreshLast();
+
+    std::vector<std::string> times_;
+    BucketStats last_;          /** summary of times_.back(), kept for addOrder */
+    std::vector<double> low_;   /** per-timestamp min price (input to the sparse table) */
+    std::vector<double> high_;  /** per-timestamp max price */
+    /** Prefix sums with a leading 0: prefix[i] = sum over timestamps [0, i). */
+    std::vector<std::size_t> countPrefix_{0};
+    std::vector<double> pricePrefix_{0.0};
+    std::vector<double> volumePrefix_{0.0};
+    std::vector<double> notionalPrefix_{0.0};
+    /** minTable_[j][i] = min of low_[i .. i + 2^j); maxTable_ likewise for high_. */
+    std::vector<std::vector<double>> minTable_;
+    std::vector<std::vector<double>> maxTable_;
+};
@@ -0,0 +1,64 @@
+/*
+ * ReloadableOrderBook.cpp — worker-thread build and atomic shared_ptr swap (see ReloadableOrderBook.h).
+ *
+ * PURPOSE: reloadAsync() runs OrderBook(filename) off the caller's thread; only when the new book is
+ * fully loaded, indexed and not empty is it published, with its version, by one std::atomic_store.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-loading.md — Hot reload.
+ *
+ * BUILD: Linked into MerkelMain. Compile with -Isrc -pthread.
+ */
+
+#include "ReloadableOrderBook.h"
+#include <iostream>
+#include <utility>
+
+// -------- Constructor / destructor --------
+
+ReloadableOrderBook::ReloadableOrderBook()
+    : published_(std::make_shared<const Published>(Published{std::make_shared<OrderBook>(), 0})) {}
+
+ReloadableOrderBook::~ReloadableOrderBook() {
+    waitForReload();
+}
+
+// -------- current: one atomic load; the caller's copy keeps that version alive --------
+
+std::shared_ptr<OrderBook> ReloadableOrderBook::current() const {
+    return std::atomic_load(&published_)->book;
+}
+
+std::shared_ptr<OrderBook> ReloadableOrderBook::current(std::uint64_t& version) const {
+    const std::shared_ptr<const Published> published = std::atomic_load(&published_);
+    version = published->version;
+    return published->book;
+}
+
+std::uint64_t ReloadableOrderBook::version() const {
+    return std::atomic_load(&published_)->version;
+}
+
+// -------- reloadAsync: build off-thread, publish book + version with one atomic store --------
+// Only the worker stores, so reading the old version there is race-free. A load with no orders
+// (missing file, nothing parsed) keeps the current book.
+
+bool ReloadableOrderBook::reloadAsync(const std::string& filename) {
+    if (reloading_.exchange(true)) return false;
+    if (worker_.joinable()) worker_.join();  // previous reload has finished; reap its thread
+    worker_ = std::thread([this, filename]() {
+        std::shared_ptr<OrderBook> fresh = std::make_shared<OrderBook>(filename);
+        if (fresh->getEntryCount() == 0) {
+            std::cerr << "Reload failed: no orders loaded from " << filename << "; keeping the current book." << std::endl;
+        } else {
+            const std::uint64_t next = std::atomic_load(&published_)->version + 1;
+            std::atomic_store(&published_, std::make_shared<const Published>(Published{std::move(fresh), next}));
+        }
+        reloading_ = false;
+    });
+    return true;
+}
+
+void ReloadableOrderBook::waitForReload() {
+    if (worker_.joinable()) worker_.join();
+}
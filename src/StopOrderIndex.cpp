@@ -0,0 +1,112 @@
+/*
+ * StopOrderIndex.cpp — implementation of StopOrderIndex: park, cancel, and trigger stop orders.
+ *
+ * PURPOSE: addStop pushes onto the product's buy (min) or sell (max) heap; onPrice pops while the
+ * top is crossed. Cancelled ids are skipped lazily; compact() rebuilds a product's heaps when
+ * stale entries outnumber live ones.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-matching.md — Stop orders and activation.
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc.
+ */
+
+#include "StopOrderIndex.h"
+#include <utility>
+
+// -------- addStop --------
+
+int StopOrderIndex::addStop(StopKind kind, double triggerPrice, const OrderBookEntry& order) {
+    const int id = nextId_++;
+    pending_.emplace(id, StopOrder{id, kind, triggerPrice, order});
+    ProductTriggers& triggers = byProduct_[order.product];
+    if (order.orderType == OrderBookType::bid) {
+        triggers.buyStops.push({triggerPrice, id});
+    } else {
+        triggers.sellStops.push({triggerPrice, id});
+    }
+    ++triggers.live;
+    return id;
+}
+
+// -------- cancelStop --------
+// Lazy deletion: forget the id; its heap entry is skipped when it reaches the top.
+
+bool StopOrderIndex::cancelStop(int id) {
+    auto it = pending_.find(id);
+    if (it == pending_.end()) return false;
+    ProductTriggers& triggers = byProduct_[it->second.order.product];
+    pending_.erase(it);
+    --triggers.live;
+    ++triggers.stale;
+    if (triggers.stale > triggers.live) compact(triggers);
+    return true;
+}
+
+// -------- onPrice --------
+// Buy stops fire when price >= trigger; sell stops when price <= trigger. Each heap stops at the
+// first entry that is not crossed, so untouched stops cost nothing.
+
+std::vector<OrderBookEntry> StopOrderIndex::onPrice(const std::string& product, double price, const std::string& timestamp) {
+    std::vector<OrderBookEntry> activated;
+    auto found = byProduct_.find(product);
+    if (found == byProduct_.end()) return activated;
+    ProductTriggers& triggers = found->second;
+
+    auto fire = [&](int id) {
+        auto it = pending_.find(id);
+        if (it == pending_.end()) {  // cancelled earlier
+            --triggers.stale;
+            return;
+        }
+        activated.push_back(release(it->second, price, timestamp));
+        pending_.erase(it);
+        --triggers.live;
+    };
+
+    while (!triggers.buyStops.empty() && triggers.buyStops.top().price <= price) {
+        const int id = triggers.buyStops.top().id;
+        triggers.buyStops.pop();
+        fire(id);
+    }
+    while (!triggers.sellStops.empty() && triggers.sellStops.top().price >= price) {
+        const int id = triggers.sellStops.top().id;
+        triggers.sellStops.pop();
+        fire(id);
+    }
+    return activated;
+}
+
+// -------- pendingCount --------
+
+std::size_t StopOrderIndex::pendingCount(const std::string& product) const {
+    auto it = byProduct_.find(product);
+    return (it == byProduct_.end()) ? 0 : it->second.live;
+}
+
+// -------- release: fired stop → order for the book --------
+
+OrderBookEntry StopOrderIndex::release(const StopOrder& stop, double price, const std::string& timestamp) {
+    OrderBookEntry order = stop.order;
+    order.timestamp = timestamp;
+    if (stop.kind == StopKind::stopLoss) order.price = price;
+    return order;
+}
+
+// -------- compact: rebuild heaps without cancelled entries --------
+
+void StopOrderIndex::compact(ProductTriggers& triggers) {
+    decltype(triggers.buyStops) buys;
+    while (!triggers.buyStops.empty()) {
+        if (pending_.count(triggers.buyStops.top().id)) buys.push(triggers.buyStops.top());
+        triggers.buyStops.pop();
+    }
+    decltype(triggers.sellStops) sells;
+    while (!triggers.sellStops.empty()) {
+        if (pending_.count(triggers.sellStops.top().id)) sells.push(triggers.sellStops.top());
+        triggers.sellStops.pop();
+    }
+    triggers.buyStops = std::move(buys);
+    triggers.sellStops = std::move(sells);
+    triggers.stale = 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * StopOrderIndex.h — pending stop-loss / stop-limit orders, indexed by trigger price.
+ *
+ * PURPOSE: Parks stop orders per product until the market price crosses their trigger, then
+ * releases them as ordinary OrderBookEntry orders. A price update only touches the orders it
+ * actually triggers: O(k log n) for k activations out of n pending stops.
+ *
+ * DESIGN: Two heaps per product, ordered so the next stop to fire is always on top:
+ *   - Buy stops (bid side) fire when price RISES to the trigger → min-heap (lowest trigger on top).
+ *   - Sell stops (ask side) fire when price FALLS to the trigger → max-heap (highest trigger on top).
+ * On a price update we pop from the top while it is crossed and stop at the first one that is not.
+ * WHY not scan a vector of stops? Strategies park tens of thousands of stops per product; a scan
+ * per price update is O(n) even when nothing fires.
+ *
+ * CANCEL: std::priority_queue cannot remove from the middle, so cancelStop() only erases the id
+ * from pending_ (lazy deletion). Stale heap entries are skipped when popped, and the heaps are
+ * rebuilt once stale entries outnumber live ones so memory stays bounded.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-matching.md — Stop orders and how activated orders enter the book.
+ *
+ * USE: Include "StopOrderIndex.h"; link StopOrderIndex.cpp. OrderBook owns one (addStopOrder,
+ * cancelStopOrder, onPriceUpdate). Build with -Isrc.
+ */
+
+#pragma once
+
+#include "OrderBookEntry.h"
+#include <cstddef>
+#include <map>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/** Stop-loss: released at the price that triggered it (market-like). Stop-limit: released at order.price. */
+enum class StopKind { stopLoss, stopLimit };
+
+/** One parked stop: trigger price plus the order to release (side, product, amount, limit price). */
+struct StopOrder {
+    int id{0};
+    StopKind kind{StopKind::stopLoss};
+    double triggerPrice{0.0};
+    OrderBookEntry order;
+};
+
+class StopOrderIndex {
+public:
+    /** Park a stop; order.orderType picks the side (bid = buy stop, ask = sell stop). Returns its id. */
+    int addStop(StopKind kind, double triggerPrice, const OrderBookEntry& order);
+
+    /** Cancel a pending stop by id. Returns false if it already fired or never existed. */
+    bool cancelStop(int id);
+
+    /** New last/best price for product: remove and return every stop it triggers, stamped with timestamp. */
+    std::vector<OrderBookEntry> onPrice(const std::string& product, double price, const std::string& timestamp);
+
+    /** Number of stops still waiting for this product (both sides). */
+    std::size_t pendingCount(const std::string& product) const;
+
+    /** Number of stops still waiting across all products. */
+    std::size_t pendingCount() const { return pending_.size(); }
+
+private:
+    struct Trigger {
+        double price;
+        int id;
+    };
+    /** Lowest trigger on top (buy stops). Ties fire in id (arrival) order. */
+    struct LowestFirst {
+        bool operator()(const Trigger& a, const Trigger& b) const {
+            return a.price > b.price || (a.price == b.price && a.id > b.id);
+        }
+    };
+    /** Highest trigger on top (sell stops). Ties fire in id (arrival) order. */
+    struct HighestFirst {
+        bool operator()(const Trigger& a, const Trigger& b) const {
+            return a.price < b.price || (a.price == b.price && a.id > b.id);
+        }
+    };
+
+    struct ProductTriggers {
+        std::priority_queue<Trigger, std::vector<Trigger>, LowestFirst> buyStops;
+        std::priority_queue<Trigger, std::vector<Trigger>, HighestFirst> sellStops;
+        std::size_t live{0};   /** pending stops for this product */
+        std::size_t stale{0};  /** cancelled entries still sitting in the heaps */
+    };
+
+    /** Turn a fired stop into the order that enters the book. */
+    static OrderBookEntry release(const StopOrder& stop, double price, const std::string& timestamp);
+
+    /** Drop cancelled entries from both heaps of one product (called when stale > live). */
+    void compact(ProductTriggers& triggers);
+
+    std::map<std::string, ProductTriggers> byProduct_;
+    /** Live stops by id; a heap entry whose id is missing here was cancelled. */
+    std::unordered_map<int, StopOrder> pending_;
+    int nextId_{1};
+};
@@ -0,0 +1,139 @@
+/*
+ * SummaryTable.cpp — build and maintain the per-(product, timestamp) summary rows (see SummaryTable.h).
+ *
+ * PURPOSE: summarize() aggregates one bucket in a single pass; finish() sorts rows by time; addOrder and
+ * refresh keep the table in step with insertOrder / cancelOrder / fillOrder.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-statistics.md — Summary table.
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc.
+ */
+
+#include "SummaryTable.h"
+#include <algorithm>
+
+namespace {
+    /** Rows order by time first so one time step's products are adjacent. */
+    bool rowLess(const SummaryRow& row, const std::string& timestamp, const std::string& product) {
+        if (row.timestamp != timestamp) return row.timestamp < timestamp;
+        return row.product < product;
+    }
+}
+
+// -------- Build --------
+
+void SummaryTable::clear() {
+    rows_.clear();
+}
+
+void SummaryTable::append(const std::string& product, const std::string& timestamp,
+                          const std::vector<OrderBookEntry>& entries) {
+    if (entries.empty()) return;
+    rows_.push_back(summarize(product, timestamp, entries));
+}
+
+void SummaryTable::finish() {
+    std::sort(rows_.begin(), rows_.end(), [](const SummaryRow& a, const SummaryRow& b) {
+        return rowLess(a, b.timestamp, b.product);
+    });
+}
+
+// -------- Maintenance --------
+// Inserts only ever grow a row, so fold in place; removals may shrink min/max/best, so recompute.
+
+void SummaryTable::addOrder(const OrderBookEntry& order) {
+    auto pos = rows_.begin() + (lowerBound(order.timestamp, order.product) - rows_.cbegin());
+    if (pos == rows_.end() || pos->timestamp != order.timestamp || pos->product != order.product) {
+        SummaryRow fresh;
+        fresh.timestamp = order.timestamp;
+        fresh.product = order.product;
+        pos = rows_.insert(pos, std::move(fresh));
+    }
+    fold(*pos, order);
+}
+
+void SummaryTable::refresh(const std::string& product, const std::string& timestamp,
+                           const std::vector<OrderBookEntry>* entries) {
+    auto pos = rows_.begin() + (lowerBound(timestamp, product) - rows_.cbegin());
+    const bool exists = pos != rows_.end() && pos->timestamp == timestamp && pos->product == product;
+    if (entries == nullptr || entries->empty()) {
+        if (exists) rows_.erase(pos);
+        return;
+    }
+    SummaryRow row = summarize(product, timestamp, *entries);
+    if (exists) *pos = std::move(row);
+    else rows_.insert(pos, std::move(row));
+}
+
+void SummaryTable::eraseBefore(const std::string& cutoff) {
+    rows_.erase(rows_.begin(), rows_.begin() + (lowerBound(cutoff, "") - rows_.cbegin()));
+}
+
+// -------- Lookups --------
+
+const SummaryRow* SummaryTable::find(const std::string& product, const std::string& timestamp) const {
+    auto it = lowerBound(timestamp, product);
+    if (it == rows_.end() || it->timestamp != timestamp || it->product != product) return nullptr;
+    return &*it;
+}
+
+std::vector<SummaryRow> SummaryTable::rowsAt(const std::string& timestamp) const {
+    std::vector<SummaryRow> out;
+    for (auto it = lowerBound(timestamp, ""); it != rows_.end() && it->timestamp == timestamp; ++it) {
+        out.push_back(*it);
+    }
+    return out;
+}
+
+SummaryRow SummaryTable::combinedAt(const std::string& timestamp) const {
+    SummaryRow combined;
+    combined.timestamp = timestamp;
+    for (auto it = lowerBound(timestamp, ""); it != rows_.end() && it->timestamp == timestamp; ++it) {
+        combined.minPrice = (combined.count == 0) ? it->minPrice : std::min(combined.minPrice, it->minPrice);
+        combined.maxPrice = (combined.count == 0) ? it->maxPrice : std::max(combined.maxPrice, it->maxPrice);
+        combined.count += it->count;
+        combined.bidCount += it->bidCount;
+        combined.bidVolume += it->bidVolume;
+        combined.askVolume += it->askVolume;
+        combined.priceSum += it->priceSum;
+    }
+    return combined;
+}
+
+// -------- Helpers --------
+
+SummaryRow SummaryTable::summarize(const std::string& product, const std::string& timestamp,
+                                   const std::vector<OrderBookEntry>& entries) {
+    SummaryRow row;
+    row.timestamp = timestamp;
+    row.product = product;
+    for (const OrderBookEntry& e : entries) fold(row, e);
+    return row;
+}
+
+void SummaryTable::fold(SummaryRow& row, const OrderBookEntry& order) {
+    if (row.count == 0) {
+        row.minPrice = order.price;
+        row.maxPrice = order.price;
+    } else {
+        row.minPrice = std::min(row.minPrice, order.price);
+        row.maxPrice = std::max(row.maxPrice, order.price);
+    }
+    if (order.orderType == OrderBookType::bid) {
+        if (row.bidCount == 0 || order.price > row.bestBid) row.bestBid = order.price;
+        ++row.bidCount;
+        row.bidVolume += order.amount;
+    } else {
+        if (row.count == row.bidCount || order.price < row.bestAsk) row.bestAsk = order.price;  // first ask
+        row.askVolume += order.amount;
+    }
+    ++row.count;
+    row.priceSum += order.price;
+}
+
+std::vector<SummaryRow>::const_iterator SummaryTable::lowerBound(const std::string& timestamp,
+                                                                 const std::string& product) const {
+    return std::lower_bound(rows_.begin(), rows_.end(), timestamp,
+                            [&product](const SummaryRow& row, const std::string& t) { return rowLess(row, t, product); });
+}
@@ -0,0 +1,95 @@
+/*
+ * SummaryTable.h — one precomputed summary row per (product, timestamp), stored contiguously by time.
+ *
+ * PURPOSE: Every menu action used to re-aggregate raw orders: printMarketStats copied the whole book
+ * (getAllEntries) just to count it, then copied and rescanned the current and previous timestamps for
+ * mean/low/high. The summary table does that aggregation once while load() fills the buckets, so
+ * stats, stepping and candle-style views read a few small rows instead of thousands of orders.
+ *
+ * DESIGN:
+ *   - SummaryRow: count (and how many are bids), bid/ask volume, min/max/sum price, best bid/ask for one bucket.
+ *   - Rows live in one std::vector sorted by (timestamp, product): all products of one time step are
+ *     adjacent, and a time range is one contiguous slice (binary search for each end).
+ *   - Kept current instead of rebuilt: an inserted order only grows count/volume/sum and can only widen
+ *     min/max and improve best bid/ask, so addOrder updates its row in O(log n). Cancel/fill can shrink
+ *     them, so OrderBook recomputes just that bucket's row (refresh).
+ *   - Tradeoff: an order at a brand-new (product, timestamp) inserts a row mid-vector (O(rows) move);
+ *     rows are per bucket, not per order, so this stays small next to the book itself.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-statistics.md — Summary table; printMarketStats reads it.
+ *
+ * USE: Include "SummaryTable.h"; link SummaryTable.cpp. OrderBook fills one in load() and exposes
+ * getSummary / getSummariesAtTime / getTimeSummary. Build with -Isrc.
+ */
+
+#pragma once
+
+#include "OrderBookEntry.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/** Aggregates of one bucket (or, from combine, of several). Prices are 0.0 when count is 0. */
+struct SummaryRow {
+    std::string timestamp;
+    std::string product;  /** empty for a row combined across products */
+    std::size_t count{0};
+    std::size_t bidCount{0};  /** asks = count - bidCount */
+    double bidVolume{0.0};
+    double askVolume{0.0};
+    double minPrice{0.0};
+    double maxPrice{0.0};
+    double priceSum{0.0};
+    double bestBid{0.0};  /** highest bid price; 0.0 if no bids */
+    double bestAsk{0.0};  /** lowest ask price; 0.0 if no asks */
+
+    /** computeAveragePrice over the bucket. */
+    double averagePrice() const { return (count > 0) ? priceSum / static_cast<double>(count) : 0.0; }
+    /** computePriceSpread over the bucket (high - low). */
+    double priceSpread() const { return maxPrice - minPrice; }
+};
+
+class SummaryTable {
+public:
+    /** Drop all rows. */
+    void clear();
+
+    /** Add the row for one bucket (any order); call finish() after the last append. */
+    void append(const std::string& product, const std::string& timestamp, const std::vector<OrderBookEntry>& entries);
+
+    /** Sort rows by (timestamp, product) once after a batch of append(). */
+    void finish();
+
+    /** Fold one inserted order into its row (creating the row if needed). Table must be finished. */
+    void addOrder(const OrderBookEntry& order);
+
+    /** Recompute the row of (product, timestamp) from its bucket; nullptr or empty bucket removes it. */
+    void refresh(const std::string& product, const std::string& timestamp, const std::vector<OrderBookEntry>* entries);
+
+    /** Drop every row with timestamp < cutoff (retention). One erase of a prefix; rows are time-sorted. */
+    void eraseBefore(const std::string& cutoff);
+
+    /** Row for (product, timestamp) or nullptr. O(log rows). */
+    const SummaryRow* find(const std::string& product, const std::string& timestamp) const;
+
+    /** Rows of every product at timestamp, product order. */
+    std::vector<SummaryRow> rowsAt(const std::string& timestamp) const;
+
+    /** Rows at timestamp folded into one (product empty, best bid/ask 0.0: not meaningful across products). */
+    SummaryRow combinedAt(const std::string& timestamp) const;
+
+    /** All rows, sorted by (timestamp, product). */
+    const std::vector<SummaryRow>& rows() const { return rows_; }
+
+private:
+    static SummaryRow summarize(const std::string& product, const std::string& timestamp,
+                                const std::vector<OrderBookEntry>& entries);
+    /** Fold order into row (row.count == 0 means fresh). */
+    static void fold(SummaryRow& row, const OrderBookEntry& order);
+
+    /** First row not less than (timestamp, product). */
+    std::vector<SummaryRow>::const_iterator lowerBound(const std::string& timestamp, const std::string& product) const;
+
+    std::vector<SummaryRow> rows_;
+};
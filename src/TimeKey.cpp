@@ -0,0 +1,98 @@
+/*
+ * TimeKey.cpp — timestamp string ↔ microseconds (see TimeKey.h).
+ *
+ * PURPOSE: Hand-rolled digit parsing (no streams, no locale) because it runs once per loaded row.
+ * Calendar math uses the days-from-civil algorithm (proleptic Gregorian, no time zones).
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-time.md — Timestamps and the time axis.
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc.
+ */
+
+#include "TimeKey.h"
+#include <cstdio>
+
+namespace {
+    /** Read n digits at s[pos]; false if any is not a digit. */
+    bool readDigits(const std::string& s, std::size_t pos, int n, int& value) {
+        if (pos + n > s.size()) return false;
+        value = 0;
+        for (int i = 0; i < n; ++i) {
+            const char c = s[pos + i];
+            if (c < '0' || c > '9') return false;
+            value = value * 10 + (c - '0');
+        }
+        return true;
+    }
+
+    /** Days since 1970-01-01 for a civil date (Howard Hinnant's days_from_civil). */
+    std::int64_t daysFromCivil(int y, int m, int d) {
+        y -= (m <= 2) ? 1 : 0;
+        const int era = (y >= 0 ? y : y - 399) / 400;
+        const int yoe = y - era * 400;
+        const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return static_cast<std::int64_t>(era) * 146097 + doe - 719468;
+    }
+
+    /** Inverse of daysFromCivil. */
+    void civilFromDays(std::int64_t z, int& y, int& m, int& d) {
+        z += 719468;
+        const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+        const int doe = static_cast<int>(z - era * 146097);
+        const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const int mp = (5 * doy + 2) / 153;
+        d = doy - (153 * mp + 2) / 5 + 1;
+        m = mp + (mp < 10 ? 3 : -9);
+        y = static_cast<int>(yoe + era * 400) + (m <= 2 ? 1 : 0);
+    }
+}
+
+// -------- parseTimestamp: "YYYY/MM/DD HH:MM:SS[.f{1,6}]" --------
+
+bool TimeKey::parseTimestamp(const std::string& timestamp, std::int64_t& micros) {
+    int year, month, day, hour, minute, sec;
+    const std::string& s = timestamp;
+    if (s.size() < 19 || s[4] != '/' || s[7] != '/' || s[10] != ' ' || s[13] != ':' || s[16] != ':') return false;
+    if (!readDigits(s, 0, 4, year) || !readDigits(s, 5, 2, month) || !readDigits(s, 8, 2, day) ||
+        !readDigits(s, 11, 2, hour) || !readDigits(s, 14, 2, minute) || !readDigits(s, 17, 2, sec)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || sec > 60) return false;
+
+    int fraction = 0;
+    if (s.size() > 19) {
+        const int digits = static_cast<int>(s.size()) - 20;
+        if (s[19] != '.' || digits < 1 || digits > 6 || !readDigits(s, 20, digits, fraction)) return false;
+        for (int i = digits; i < 6; ++i) fraction *= 10;  // ".5" means 500000 µs
+    }
+    const std::int64_t seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + sec;
+    micros = seconds * second + fraction;
+    return true;
+}
+
+// -------- formatTimestamp --------
+
+std::string TimeKey::formatTimestamp(std::int64_t micros) {
+    std::int64_t seconds = micros / second;
+    std::int64_t fraction = micros % second;
+    if (fraction < 0) {
+        fraction += second;
+        --seconds;
+    }
+    std::int64_t days = seconds / 86400;
+    std::int64_t secOfDay = seconds % 86400;
+    if (secOfDay < 0) {
+        secOfDay += 86400;
+        --days;
+    }
+    int y, m, d;
+    civilFromDays(days, y, m, d);
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%04d/%02d/%02d %02d:%02d:%02d.%06d", y, m, d,
+                  static_cast<int>(secOfDay / 3600), static_cast<int>(secOfDay / 60 % 60),
+                  static_cast<int>(secOfDay % 60), static_cast<int>(fraction));
+    return buf;
+}
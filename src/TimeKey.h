@@ -0,0 +1,31 @@
+/*
+ * TimeKey.h — convert CSV timestamps ("2020/03/17 17:01:24.884492") to and from integer microseconds.
+ *
+ * PURPOSE: String timestamps sort correctly but are slow to compare and cannot be subtracted. A
+ * 64-bit count of microseconds since 1970-01-01 keeps the same order, fits in a register, and lets
+ * fixed-width structures (B+tree nodes, arrays, buckets of N seconds) work on time directly.
+ *
+ * FORMAT: "YYYY/MM/DD HH:MM:SS" with an optional fraction of 1–6 digits (".884492"). Anything else
+ * is rejected (parseTimestamp returns false) so callers can fall back to string handling.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-time.md — Timestamps in the data; the time axis.
+ *
+ * USE: Include "TimeKey.h"; link TimeKey.cpp. Build with -Isrc.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace TimeKey {
+    /** Microseconds per second; handy for bucket widths (e.g. 10 * TimeKey::second). */
+    constexpr std::int64_t second = 1000000;
+
+    /** Parse a CSV timestamp into microseconds since 1970-01-01. Returns false if the format is wrong. */
+    bool parseTimestamp(const std::string& timestamp, std::int64_t& micros);
+
+    /** Format microseconds as "YYYY/MM/DD HH:MM:SS.ffffff" (always six fraction digits). */
+    std::string formatTimestamp(std::int64_t micros);
+}
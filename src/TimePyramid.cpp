@@ -0,0 +1,106 @@
+/*
+ * TimePyramid.cpp — bottom-up build and level selection (see TimePyramid.h).
+ *
+ * PURPOSE: append() folds timestamps into 1-second rows; finish() merges each level into the next;
+ * addOrder() redoes the last row of each level for a live insert; rows() picks the level for a window
+ * and copies its rows out.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-statistics.md — Zoomable time series (pyramid).
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc.
+ */
+
+#include "TimePyramid.h"
+#include "TimeKey.h"
+#include <algorithm>
+#include <limits>
+
+const std::array<std::int64_t, ProductPyramid::kLevels> ProductPyramid::kWidths = {
+    TimeKey::second, 10 * TimeKey::second, 60 * TimeKey::second, 600 * TimeKey::second, 3600 * TimeKey::second};
+
+namespace {
+    /** Floor to a multiple of width (also for times before 1970). */
+    std::int64_t floorTo(std::int64_t micros, std::int64_t width) {
+        const std::int64_t r = micros % width;
+        return micros - r - (r < 0 ? width : 0);
+    }
+
+    /** Fold stats of bucket start into the last row of rows, or open a new row. open gets the last
+        row as it was before the merge. */
+    void fold(std::vector<PyramidRow>& rows, std::int64_t start, std::int64_t width, const BucketStats& stats,
+              BucketStats& open) {
+        if (rows.empty() || rows.back().start != start) {
+            PyramidRow row;
+            row.start = start;
+            row.width = width;
+            rows.push_back(row);
+        }
+        open = rows.back().stats;
+        rows.back().stats.merge(stats);
+    }
+}
+
+// -------- Build: timestamps → 1s, then each level from the one below --------
+
+bool ProductPyramid::append(const std::string& timestamp, const BucketStats& stats) {
+    std::int64_t micros = 0;
+    if (!TimeKey::parseTimestamp(timestamp, micros)) return false;
+    fold(levels_[0], floorTo(micros, kWidths[0]), kWidths[0], stats, open_[0]);
+    lastTime_ = timestamp;
+    lastStats_ = stats;
+    return true;
+}
+
+void ProductPyramid::finish() {
+    for (std::size_t i = 1; i < kLevels; ++i) {
+        levels_[i].clear();
+        for (const PyramidRow& row : levels_[i - 1]) {
+            fold(levels_[i], floorTo(row.start, kWidths[i]), kWidths[i], row.stats, open_[i]);
+        }
+        levels_[i].shrink_to_fit();
+    }
+}
+
+// -------- Live insert: redo each level's last row as open_ + its newest child --------
+
+bool ProductPyramid::addOrder(const std::string& timestamp, double price, double amount) {
+    std::int64_t micros = 0;
+    if (!TimeKey::parseTimestamp(timestamp, micros)) return false;
+    const bool newTime = levels_[0].empty() || lastTime_ < timestamp;
+    if (!newTime && lastTime_ != timestamp) return false;
+    if (newTime) {
+        lastTime_ = timestamp;
+        lastStats_ = BucketStats();
+    }
+    lastStats_.add(price, amount);
+    bool newChild = newTime;
+    for (std::size_t i = 0; i < kLevels; ++i) {
+        std::vector<PyramidRow>& rows = levels_[i];
+        const BucketStats& child = (i == 0) ? lastStats_ : levels_[i - 1].back().stats;
+        const std::int64_t start = floorTo(micros, kWidths[i]);
+        if (newChild) {
+            const std::size_t before = rows.size();
+            fold(rows, start, kWidths[i], child, open_[i]);
+            newChild = (rows.size() != before);  // a new row here is a new child of the level above
+        } else {
+            rows.back().stats = open_[i];
+            rows.back().stats.merge(child);
+        }
+    }
+    return true;
+}
+
+// -------- Query: finest level that fits --------
+
+std::vector<PyramidRow> ProductPyramid::rows(std::int64_t from, std::int64_t to, std::size_t maxRows) const {
+    auto startLess = [](const PyramidRow& row, std::int64_t t) { return row.start < t; };
+    for (std::size_t i = 0; i < kLevels; ++i) {
+        const std::vector<PyramidRow>& rows = levels_[i];
+        const bool unbounded = from < std::numeric_limits<std::int64_t>::min() + kWidths[i];
+        auto first = std::lower_bound(rows.begin(), rows.end(), unbounded ? from : floorTo(from, kWidths[i]), startLess);
+        auto last = std::upper_bound(first, rows.end(), to, [](std::int64_t t, const PyramidRow& row) { return t < row.start; });
+        if (static_cast<std::size_t>(last - first) <= maxRows || i + 1 == kLevels) return std::vector<PyramidRow>(first, last);
+    }
+    return {};
+}
@@ -0,0 +1,81 @@
+/*
+ * TimePyramid.h — multi-resolution pre-aggregated stats per product: low / high / average price and
+ * volume at 1s, 10s, 1m, 10m and 1h buckets, for charts that zoom.
+ *
+ * PURPOSE: A chart of a day at 1-second detail is 86 400 points; a chart of a month cannot be drawn
+ * from raw orders per request at all. Re-aggregating the raw orders for every chart request costs a
+ * scan of the whole window. The pyramid keeps every zoom level ready, so any window is served from
+ * the finest level that fits the chart in a bounded number of rows.
+ *
+ * DESIGN:
+ *   - Level 0 (1s) is built from the per-timestamp BucketStats that OrderBook already computes for
+ *     RangeStats, in the same pass after load. Each coarser level is built from the level below it
+ *     (10 x 1s, 6 x 10s, 10 x 1m, 6 x 10m): widths divide each other, so merging whole rows is exact
+ *     and each level costs one linear pass over a level 10 or 6 times smaller.
+ *   - Rows are sparse: only buckets with at least one timestamp exist. Rows are sorted by start, so
+ *     a window is two binary searches per level.
+ *   - Live inserts: addOrder folds one order at the latest timestamp (or a new later one) into the
+ *     last row of every level. Each level remembers its last row without its newest child (open_), so
+ *     the row is redone as open_ + child: the same merges in the same order as finish(), bit for bit.
+ *   - rows(from, to, maxRows): finest level whose row count over the window is <= maxRows; the
+ *     coarsest (1h) if none is. Buckets are whole, so a window boundary inside a bucket includes it.
+ *   - Tradeoff: timestamps TimeKey cannot parse are left out of the pyramid (they are still in
+ *     getWindowStats). Memory: at most about 1.12 rows per distinct second.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-statistics.md — Zoomable time series (pyramid).
+ *
+ * USE: Include "TimePyramid.h"; link TimePyramid.cpp. OrderBook builds one per product with its window
+ * tables (buildRangeStats) and answers getChartRows(product, from, to, maxRows). Build with -Isrc.
+ */
+
+#pragma once
+
+#include "RangeStats.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** One bucket of one pyramid level. */
+struct PyramidRow {
+    std::int64_t start{0};  /** bucket start, TimeKey microseconds */
+    std::int64_t width{0};  /** bucket width in microseconds (the level) */
+    BucketStats stats;      /** every order of every timestamp in [start, start + width) */
+
+    /** Unweighted mean price (as WindowStats::averagePrice); 0.0 if the bucket is empty. */
+    double averagePrice() const { return stats.count ? stats.priceSum / static_cast<double>(stats.count) : 0.0; }
+    /** Volume-weighted average price; 0.0 if there is no volume. */
+    double vwap() const { return (stats.volume > 0.0) ? stats.notional / stats.volume : 0.0; }
+};
+
+class ProductPyramid {
+public:
+    static constexpr std::size_t kLevels = 5;
+    /** Bucket width of each level in microseconds: 1s, 10s, 1m, 10m, 1h. */
+    static const std::array<std::int64_t, kLevels> kWidths;
+
+    /** Add the next timestamp's summary. Timestamps must arrive in ascending order. Returns false
+        (and skips it) if TimeKey cannot parse the timestamp. */
+    bool append(const std::string& timestamp, const BucketStats& stats);
+
+    /** Build the coarser levels from level 0; call once after the last append. */
+    void finish();
+
+    /** One more order at timestamp, after finish(), in O(levels). Returns false, changing nothing, if
+        timestamp is older than the latest appended one or TimeKey cannot parse it. */
+    bool addOrder(const std::string& timestamp, double price, double amount);
+
+    /** All rows of one level (0 = 1s ... kLevels - 1 = 1h). */
+    const std::vector<PyramidRow>& level(std::size_t index) const { return levels_[index]; }
+
+    /** Rows of the finest level that covers [from, to] (microseconds) in at most maxRows rows. */
+    std::vector<PyramidRow> rows(std::int64_t from, std::int64_t to, std::size_t maxRows) const;
+
+private:
+    std::array<std::vector<PyramidRow>, kLevels> levels_;
+    std::string lastTime_;                   /** latest appended timestamp */
+    BucketStats lastStats_;                  /** its summary (level 0's newest child) */
+    std::array<BucketStats, kLevels> open_;  /** each level's last row before its newest child merged */
+};
@@ -0,0 +1,89 @@
+/*
+ * TopOfBookTicker.h — per-product top of book (best bid/ask price and size) published through a seqlock.
+ *
+ * PURPOSE: The book thread (insertOrder, matching) is the single writer; any number of reader
+ * threads (signals, UIs) poll the latest top of book without locks and without copying the book.
+ * A reader can never block the writer: publish() never waits for anyone.
+ *
+ * DESIGN (seqlock): sequence_ is even while the record is stable and odd while a write is in
+ * progress. The writer bumps it to odd, stores the fields, then bumps it to even. A reader loads the
+ * sequence, loads the fields, loads the sequence again; if both loads match and are even, the fields
+ * form one consistent snapshot. Otherwise a write overlapped and the reader tries again.
+ * WHY a seqlock instead of a mutex? Readers vastly outnumber writes, and with a mutex a slow reader
+ * could stall the book thread. Here readers only retry; the writer is never delayed.
+ * The fields are std::atomic<double> with relaxed ordering so the overlapping read is not a data
+ * race in C++ terms; the fences give the ordering. On x86-64 and ARM64 these are plain loads/stores.
+ *
+ * Wait-free vs lock-free: tryRead() makes one attempt and returns false if it raced a write
+ * (wait-free). read() loops until it gets a clean snapshot (lock-free; it only retries while the
+ * writer is mid-publish).
+ *
+ * DOCS (embedded references):
+ *   docs/trading-market-basics.md — Best bid/ask; top of book for other threads.
+ *
+ * USE: Header-only (so the reader loop inlines). OrderBook owns one per product; get a pointer with
+ * OrderBook::getTicker(product) on the book thread before starting readers. Build with -Isrc.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/** One consistent top-of-book snapshot. sequence counts publishes (0 = never published). */
+struct TopOfBook {
+    double bidPrice{0.0};
+    double bidSize{0.0};
+    double askPrice{0.0};
+    double askSize{0.0};
+    std::uint64_t sequence{0};
+};
+
+/** alignas(64): each ticker gets its own cache line so products do not false-share. */
+class alignas(64) TopOfBookTicker {
+public:
+    /** Writer only (book thread). Never blocks. */
+    void publish(const TopOfBook& top) {
+        const std::uint64_t seq = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(seq + 1, std::memory_order_relaxed);  // odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        bidPrice_.store(top.bidPrice, std::memory_order_relaxed);
+        bidSize_.store(top.bidSize, std::memory_order_relaxed);
+        askPrice_.store(top.askPrice, std::memory_order_relaxed);
+        askSize_.store(top.askSize, std::memory_order_relaxed);
+        sequence_.store(seq + 2, std::memory_order_release);  // even: stable again
+    }
+
+    /** One attempt (wait-free). Returns false if a publish overlapped; out is then unspecified. */
+    bool tryRead(TopOfBook& out) const {
+        const std::uint64_t before = sequence_.load(std::memory_order_acquire);
+        if (before & 1) return false;
+        out.bidPrice = bidPrice_.load(std::memory_order_relaxed);
+        out.bidSize = bidSize_.load(std::memory_order_relaxed);
+        out.askPrice = askPrice_.load(std::memory_order_relaxed);
+        out.askSize = askSize_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const std::uint64_t after = sequence_.load(std::memory_order_relaxed);
+        if (before != after) return false;
+        out.sequence = before / 2;
+        return true;
+    }
+
+    /** Latest consistent snapshot; retries only while a publish is in progress. */
+    TopOfBook read() const {
+        TopOfBook out;
+        while (!tryRead(out)) {
+        }
+        return out;
+    }
+
+    /** Publishes so far; cheap change check for pollers (compare with the last value seen). */
+    std::uint64_t sequence() const { return sequence_.load(std::memory_order_acquire) / 2; }
+
+private:
+    std::atomic<std::uint64_t> sequence_{0};
+    std::atomic<double> bidPrice_{0.0};
+    std::atomic<double> bidSize_{0.0};
+    std::atomic<double> askPrice_{0.0};
+    std::atomic<double> askSize_{0.0};
+};
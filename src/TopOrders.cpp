@@ -0,0 +1,114 @@
+/*
+ * TopOrders.cpp — per-thread bounded heaps and the final merge (see TopOrders.h).
+ *
+ * PURPOSE: add() cuts a round of buckets into one slice per worker; each worker offers its rows to its
+ * own heaps; finish() merges the heaps of each product and sorts the survivors.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-statistics.md — Largest orders (top K).
+ *
+ * BUILD: Linked into MerkelMain via OrderBook. Compile with -Isrc -pthread.
+ */
+
+#include "TopOrders.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+    /** a ranks above b: larger value, or the same value earlier in the book. */
+    template <typename C>
+    bool better(const C& a, const C& b) {
+        return a.rank > b.rank || (a.rank == b.rank && a.position < b.position);
+    }
+}
+
+TopOrderSelector::TopOrderSelector(const TopOrdersSpec& spec, const OrderQuery& filter, unsigned threads)
+    : spec_(spec), filter_(filter) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    heaps_.resize(threads);
+}
+
+// -------- add: one slice per worker, balanced by order count --------
+
+void TopOrderSelector::add(const std::vector<TopOrderInput>& inputs) {
+    if (inputs.empty() || spec_.k == 0 || filter_.matchesNothing()) return;
+    std::size_t total = 0;
+    std::uint32_t products = 0;
+    for (const TopOrderInput& in : inputs) {
+        total += in.orders->size();
+        products = std::max(products, in.product + 1);
+    }
+    for (std::vector<Heap>& heaps : heaps_) {
+        if (heaps.size() < products) heaps.resize(products);
+    }
+    const std::size_t slices = std::min(heaps_.size(), inputs.size());
+
+    std::vector<std::size_t> sliceStart(1, 0);
+    std::size_t rows = 0;
+    for (std::size_t i = 0; i < inputs.size() && sliceStart.size() < slices; ++i) {
+        rows += inputs[i].orders->size();
+        if (rows * slices >= total * sliceStart.size()) sliceStart.push_back(i + 1);
+    }
+    sliceStart.push_back(inputs.size());
+
+    std::vector<std::thread> workers;
+    for (std::size_t s = 1; s + 1 < sliceStart.size(); ++s) {
+        workers.emplace_back([&, s]() {
+            OrderBatch batch;
+            select(inputs, sliceStart[s], sliceStart[s + 1], heaps_[s], batch);
+        });
+    }
+    OrderBatch batch;
+    select(inputs, sliceStart[0], sliceStart[1], heaps_[0], batch);
+    for (std::thread& worker : workers) worker.join();
+}
+
+void TopOrderSelector::select(const std::vector<TopOrderInput>& inputs, std::size_t begin, std::size_t end,
+                              std::vector<Heap>& heaps, OrderBatch& batch) const {
+    // "better" as the heap's less-than puts the weakest candidate at the front.
+    auto heapOrder = [](const Candidate& a, const Candidate& b) { return better(a, b); };
+    const bool byNotional = (spec_.rank == TopOrderRank::notional);
+    for (std::size_t b = begin; b < end; ++b) {
+        const std::vector<OrderBookEntry>& orders = *inputs[b].orders;
+        Heap& heap = heaps[inputs[b].product];
+        for (std::size_t first = 0; first < orders.size(); first += OrderBatch::kRows) {
+            const OrderBookEntry* rows = orders.data() + first;
+            const std::size_t k = filter_.selectEntries(rows, std::min(OrderBatch::kRows, orders.size() - first), batch);
+            for (std::size_t j = 0; j < k; ++j) {
+                const std::uint32_t row = static_cast<std::uint32_t>(first + batch.sel[j]);
+                const OrderBookEntry& e = orders[row];
+                const double rank = byNotional ? e.price * e.amount : e.amount;
+                if (rank != rank) continue;  // NaN (bad data) cannot be ranked
+                const std::uint64_t position = (static_cast<std::uint64_t>(inputs[b].sequence) << 32) | row;
+                if (heap.size() == spec_.k) {
+                    const Candidate& weakest = heap.front();
+                    if (!(rank > weakest.rank || (rank == weakest.rank && position < weakest.position))) continue;
+                    std::pop_heap(heap.begin(), heap.end(), heapOrder);
+                    heap.back() = Candidate{rank, position, e};
+                } else {
+                    heap.push_back(Candidate{rank, position, e});
+                }
+                std::push_heap(heap.begin(), heap.end(), heapOrder);
+            }
+        }
+    }
+}
+
+// -------- finish: merge each product's heaps, best K, largest first --------
+
+std::vector<OrderBookEntry> TopOrderSelector::finish() {
+    std::vector<OrderBookEntry> out;
+    const std::size_t products = heaps_.empty() ? 0 : heaps_[0].size();
+    for (std::size_t p = 0; p < products; ++p) {
+        Heap merged;
+        for (std::vector<Heap>& heaps : heaps_) {
+            merged.insert(merged.end(), std::make_move_iterator(heaps[p].begin()), std::make_move_iterator(heaps[p].end()));
+            Heap().swap(heaps[p]);
+        }
+        const std::size_t keep = std::min(spec_.k, merged.size());
+        std::partial_sort(merged.begin(), merged.begin() + static_cast<std::ptrdiff_t>(keep), merged.end(),
+                          [](const Candidate& a, const Candidate& b) { return better(a, b); });
+        for (std::size_t i = 0; i < keep; ++i) out.push_back(std::move(merged[i].entry));
+    }
+    return out;
+}
@@ -0,0 +1,76 @@
+/*
+ * TopOrders.h — the K largest resting orders by amount or notional, overall or per product, over an
+ * OrderQuery's product and time range, by bounded heap selection on several threads.
+ *
+ * PURPOSE: Finding whales meant getAllEntries plus a full sort: a copy of the whole book and
+ * O(n log n) work for a result of ten rows. Selecting the top K needs one pass and K slots per worker.
+ *
+ * DESIGN:
+ *   - Workers take contiguous slices of buckets (balanced by order count, as in GroupBy) and keep one
+ *     bounded min-heap of K candidates per product (one in all when not per product). The heap's top
+ *     is the weakest candidate, so most rows cost one comparison against it and are dropped; only a
+ *     row that beats it is copied in (O(log K)). Rows are pre-filtered by OrderQuery::selectEntries.
+ *   - finish() merges the per-thread heaps of each product and keeps the best K: threads x K
+ *     candidates per product, not n.
+ *   - Ties: equal ranks are broken by position in the book (product, timestamp, row in the bucket), so
+ *     the result does not depend on the thread count.
+ *   - Tradeoff: candidates are copies of OrderBookEntry (buckets may be paged out between rounds);
+ *     fine for small K, wasteful for K in the millions — use query() and sort for that.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-statistics.md — Largest orders (top K).
+ *
+ * USE: Include "TopOrders.h"; link TopOrders.cpp. Call OrderBook::topOrders. Build with -Isrc -pthread.
+ */
+
+#pragma once
+
+#include "OrderBookEntry.h"
+#include "OrderQuery.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class TopOrderRank { amount, notional };
+
+/** How many of which orders OrderBook::topOrders returns. */
+struct TopOrdersSpec {
+    std::size_t k{10};
+    TopOrderRank rank{TopOrderRank::amount};  /** amount, or price * amount */
+    bool perProduct{false};                   /** K per product instead of K in all */
+};
+
+/** One bucket's orders with its product id and its position among all buckets of the call. */
+struct TopOrderInput {
+    const std::vector<OrderBookEntry>* orders{nullptr};
+    std::uint32_t product{0};  /** 0 when not per product */
+    std::uint32_t sequence{0}; /** bucket number in book order (tie-break) */
+};
+
+class TopOrderSelector {
+public:
+    /** threads = 0 uses hardware_concurrency. */
+    TopOrderSelector(const TopOrdersSpec& spec, const OrderQuery& filter, unsigned threads);
+
+    /** Select from one round of buckets in parallel; the orders must stay valid until it returns. */
+    void add(const std::vector<TopOrderInput>& inputs);
+
+    /** The best K (per product id, in id order), largest first. */
+    std::vector<OrderBookEntry> finish();
+
+private:
+    struct Candidate {
+        double rank;
+        std::uint64_t position;  /** sequence << 32 | row: smaller wins a tie */
+        OrderBookEntry entry;
+    };
+    using Heap = std::vector<Candidate>;  /** bounded: front() is the weakest candidate */
+
+    /** Select from inputs[begin, end) into heaps (indexed by product id) with the thread's own batch. */
+    void select(const std::vector<TopOrderInput>& inputs, std::size_t begin, std::size_t end,
+                std::vector<Heap>& heaps, OrderBatch& batch) const;
+
+    TopOrdersSpec spec_;
+    OrderQuery filter_;
+    std::vector<std::vector<Heap>> heaps_;  /** [worker][product id], kept across rounds */
+};
@@ -0,0 +1,86 @@
+/*
+ * VolatilityMonitor.cpp — O(1) per-quote updates of the estimators (see VolatilityMonitor.h).
+ *
+ * PURPOSE: onQuote turns a quote into a return and folds it into the product's ring, running sum and
+ * EWMA state; onTimeStep feeds a whole replay step.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-statistics.md — Streaming volatility and spikes.
+ *
+ * BUILD: Linked into MerkelMain. Compile with -Isrc.
+ */
+
+#include "VolatilityMonitor.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+VolatilityMonitor::VolatilityMonitor(const VolatilityConfig& config) : config_(config) {
+    config_.window = std::max<std::size_t>(config_.window, 1);
+    config_.ewmaAlpha = std::min(std::max(config_.ewmaAlpha, 0.0), 1.0);
+}
+
+bool VolatilityMonitor::onQuote(const std::string& product, const std::string& timestamp, double bestBid,
+                                double bestAsk, std::vector<VolatilityEvent>& out) {
+    if (!(bestBid > 0.0) || !(bestAsk > 0.0)) return false;
+    ProductState& s = products_[product];
+    if (!s.lastTimestamp.empty() && timestamp <= s.lastTimestamp) return false;
+    const double mid = (bestBid + bestAsk) / 2.0;
+    const double previous = s.lastMid;
+    s.lastTimestamp = timestamp;
+    s.lastMid = mid;
+    if (previous <= 0.0) {  // first mid: nothing to return against yet
+        s.squares.assign(config_.window, 0.0);
+        return false;
+    }
+    const double r = std::log(mid / previous);
+    VolatilityEvent& e = s.latest;
+    ++e.returns;
+
+    // z against the estimates before r; flags only once warm and with some variance to compare to.
+    const double sd = std::sqrt(s.variance);
+    e.zScore = (e.returns > config_.warmup && sd > 0.0) ? (r - s.mean) / sd : 0.0;
+
+    // Realized volatility: swap r^2 into the ring; re-sum once per full turn to cancel drift.
+    s.sumSquares += r * r - s.squares[s.head];
+    s.squares[s.head] = r * r;
+    if (++s.head == s.squares.size()) {
+        s.head = 0;
+        s.sumSquares = std::accumulate(s.squares.begin(), s.squares.end(), 0.0);
+    }
+
+    // EWMA: the first return seeds the mean; variance grows from 0.
+    if (e.returns == 1) {
+        s.mean = r;
+    } else {
+        const double d = r - s.mean;
+        s.mean += config_.ewmaAlpha * d;
+        s.variance = (1.0 - config_.ewmaAlpha) * (s.variance + config_.ewmaAlpha * d * d);
+    }
+
+    e.kind = (std::fabs(e.zScore) >= config_.spikeZ) ? VolatilityEventKind::spike : VolatilityEventKind::update;
+    e.product = product;
+    e.timestamp = timestamp;
+    e.mid = mid;
+    e.logReturn = r;
+    e.realizedVol = std::sqrt(std::max(s.sumSquares, 0.0));
+    e.ewmaMean = s.mean;
+    e.ewmaVol = std::sqrt(s.variance);
+    out.push_back(e);
+    return true;
+}
+
+std::size_t VolatilityMonitor::onTimeStep(const std::vector<SummaryRow>& rows, std::vector<VolatilityEvent>& out) {
+    std::size_t emitted = 0;
+    for (const SummaryRow& row : rows) {
+        emitted += onQuote(row.product, row.timestamp, row.bestBid, row.bestAsk, out) ? 1 : 0;
+    }
+    return emitted;
+}
+
+bool VolatilityMonitor::getLatest(const std::string& product, VolatilityEvent& out) const {
+    auto it = products_.find(product);
+    if (it == products_.end() || it->second.latest.returns == 0) return false;
+    out = it->second.latest;
+    return true;
+}
@@ -0,0 +1,96 @@
+/*
+ * VolatilityMonitor.h — streaming per-product volatility estimates and spike detection.
+ *
+ * PURPOSE: computePriceChange / computePercentChange compare two windows, recomputed from the orders
+ * each time they are asked. A replay (or a live feed) wants running answers instead: how volatile is
+ * each product right now, and did this move stand out? VolatilityMonitor keeps a few numbers per
+ * product and updates them in O(1) per quote, never looking back at the history.
+ *
+ * DESIGN (per product, fed mid prices (bestBid + bestAsk) / 2 in time order):
+ *   - Return r = ln(mid / previous mid).
+ *   - Realized volatility = sqrt(sum of r^2 over the last `window` returns): a ring buffer of r^2 and a
+ *     running sum (add the new square, subtract the one leaving). The sum is recomputed from the ring
+ *     once per `window` returns, so subtraction drift cannot build up (O(1) amortized).
+ *   - EWMA mean / variance of r with weight alpha: d = r - mean; mean += alpha * d;
+ *     var = (1 - alpha) * (var + alpha * d * d).
+ *   - z = (r - mean) / sqrt(var) with mean / var from *before* r is folded in, so a spike is judged
+ *     against the calm that preceded it. |z| >= spikeZ after `warmup` returns is a spike.
+ *   - Every return emits one VolatilityEvent (kind update or spike) into the caller's vector, like
+ *     OrderBook::onPriceUpdate returns the stops it fired.
+ *   - Tradeoff: a quote needs both sides (no mid otherwise) and is skipped if its timestamp is not after
+ *     the product's previous one; gaps between quotes are not time-weighted.
+ *
+ * DOCS (embedded references):
+ *   docs/orderbook-statistics.md — Streaming volatility and spikes.
+ *
+ * USE: Include "VolatilityMonitor.h"; link VolatilityMonitor.cpp. Not thread-safe: feed it from one
+ * thread (e.g. the replay loop). Build with -Isrc.
+ */
+
+#pragma once
+
+#include "SummaryTable.h"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+struct VolatilityConfig {
+    double ewmaAlpha{0.1};   /** weight of the newest return in the EWMA mean / variance */
+    std::size_t window{30};  /** returns in the realized-volatility window */
+    double spikeZ{4.0};      /** |z| at or above this is a spike */
+    std::size_t warmup{10};  /** returns seen before z-scores can flag spikes */
+};
+
+enum class VolatilityEventKind { update, spike };
+
+/** The estimates of one product right after a new return. */
+struct VolatilityEvent {
+    VolatilityEventKind kind{VolatilityEventKind::update};
+    std::string product;
+    std::string timestamp;
+    double mid{0.0};
+    double logReturn{0.0};    /** ln(mid / previous mid) */
+    double realizedVol{0.0};  /** sqrt(sum of squared returns over the window) */
+    double ewmaMean{0.0};     /** after this return */
+    double ewmaVol{0.0};      /** sqrt(EWMA variance) after this return */
+    double zScore{0.0};       /** of this return against the estimates before it; 0.0 until warm */
+    std::size_t returns{0};   /** returns seen for the product so far */
+};
+
+class VolatilityMonitor {
+public:
+    explicit VolatilityMonitor(const VolatilityConfig& config = VolatilityConfig());
+
+    /** Feed product's best bid / ask at timestamp. If it makes a new return, appends one event to out and
+        returns true; false if skipped (a side missing, or timestamp not after the last one) or it is the
+        product's first mid. */
+    bool onQuote(const std::string& product, const std::string& timestamp, double bestBid, double bestAsk,
+                 std::vector<VolatilityEvent>& out);
+
+    /** Feed one time step of summary rows (OrderBook::getSummariesAtTime). Returns events appended. */
+    std::size_t onTimeStep(const std::vector<SummaryRow>& rows, std::vector<VolatilityEvent>& out);
+
+    /** Latest event of product (after at least one return); false if none yet. */
+    bool getLatest(const std::string& product, VolatilityEvent& out) const;
+
+    /** Forget every product (e.g. when the replay restarts or the book is reloaded). */
+    void reset() { products_.clear(); }
+
+    const VolatilityConfig& getConfig() const { return config_; }
+
+private:
+    struct ProductState {
+        std::string lastTimestamp;
+        double lastMid{0.0};
+        std::vector<double> squares;  /** ring of the last `window` r^2 */
+        std::size_t head{0};          /** next slot to overwrite */
+        double sumSquares{0.0};
+        double mean{0.0};
+        double variance{0.0};
+        VolatilityEvent latest;       /** returns == 0 until the first return */
+    };
+
+    VolatilityConfig config_;
+    std::map<std::string, ProductState> products_;
+};